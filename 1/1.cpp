@@ -1,61 +1,351 @@
 #include <iostream>
-#include <fstream>
-#include <sstream>
 #include <vector>
 #include <string>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <queue>
+#include <array>
+#include <future>
+#include <thread>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#if defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
 
 /**
- * Reads a file with two tab-separated columns into two lists.
+ * Parses a single line of two whitespace-separated integers, starting at pos.
+ * On success pos is left just past the line's newline (or at the end of the data).
+ *
+ * @param data The file contents.
+ * @param size The number of bytes in data.
+ * @param pos The offset of the start of the line.
+ * @param item1 A reference to store the first integer.
+ * @param item2 A reference to store the second integer.
+ * @return True if the line held two integers, false otherwise.
+ */
+bool parseLine(const char* data, size_t size, size_t& pos, int& item1, int& item2) {
+    int* items[2] = {&item1, &item2};
+    for (int* item : items) {
+        // Skip the whitespace before the number
+        while (pos < size && (data[pos] == ' ' || data[pos] == '\t')) {
+            pos++;
+        }
+        bool negative = pos < size && data[pos] == '-';
+        if (negative) {
+            pos++;
+        }
+        if (pos >= size || data[pos] < '0' || data[pos] > '9') {
+            return false;
+        }
+        int value = 0;
+        while (pos < size && data[pos] >= '0' && data[pos] <= '9') {
+            value = value * 10 + (data[pos] - '0');
+            pos++;
+        }
+        *item = negative ? -value : value;
+    }
+
+    // Only trailing whitespace may follow the second number
+    while (pos < size && (data[pos] == ' ' || data[pos] == '\t' || data[pos] == '\r')) {
+        pos++;
+    }
+    if (pos < size) {
+        if (data[pos] != '\n') {
+            return false;
+        }
+        pos++;
+    }
+    return true;
+}
+
+/**
+ * Layout of a fixed-width record such as "NNNNN   NNNNN\n".
+ */
+struct RecordLayout {
+    size_t width = 0;
+    size_t digits1 = 0;
+    size_t start2 = 0;
+    size_t digits2 = 0;
+};
+
+/**
+ * Detects the fixed record layout from the first line of the file. Only layouts that fit in
+ * a 16-byte vector with at most 8 digits per column are accepted.
+ *
+ * @param data The file contents.
+ * @param size The number of bytes in data.
+ * @param layout A reference to store the detected layout.
+ * @return True if the first line has a usable fixed-width layout, false otherwise.
+ */
+bool detectRecordLayout(const char* data, size_t size, RecordLayout& layout) {
+    size_t pos = 0;
+    while (pos < size && data[pos] >= '0' && data[pos] <= '9') {
+        pos++;
+    }
+    layout.digits1 = pos;
+    while (pos < size && data[pos] == ' ') {
+        pos++;
+    }
+    layout.start2 = pos;
+    while (pos < size && data[pos] >= '0' && data[pos] <= '9') {
+        pos++;
+    }
+    layout.digits2 = pos - layout.start2;
+    if (pos >= size || data[pos] != '\n') {
+        return false;
+    }
+    layout.width = pos + 1;
+    return layout.digits1 >= 1 && layout.digits1 <= 8 && layout.start2 > layout.digits1 &&
+           layout.digits2 >= 1 && layout.digits2 <= 8 && layout.width <= 16;
+}
+
+#if defined(__SSE4_1__)
+/**
+ * SIMD parser for records that follow a fixed layout. The record is loaded as one 16-byte
+ * vector, validated against the layout, and both columns are converted at once: the digits
+ * of each column are shuffled right-aligned into one 8-byte half and then combined pairwise
+ * (x10, x100, x10000) with multiply-add instructions.
+ */
+class FixedWidthParser {
+public:
+    explicit FixedWidthParser(const RecordLayout& layout) {
+        alignas(16) uint8_t shuffle[16];
+        alignas(16) uint8_t digitMask[16];
+        alignas(16) uint8_t literals[16];
+        alignas(16) uint8_t literalMask[16];
+        for (size_t i = 0; i < 16; i++) {
+            shuffle[i] = 0x80;
+            digitMask[i] = 0;
+            literals[i] = 0;
+            literalMask[i] = 0;
+        }
+        for (size_t i = 0; i < layout.width; i++) {
+            if (i < layout.digits1 || (i >= layout.start2 && i < layout.start2 + layout.digits2)) {
+                digitMask[i] = 0xFF;
+            } else {
+                literals[i] = (i == layout.width - 1) ? '\n' : ' ';
+                literalMask[i] = 0xFF;
+            }
+        }
+        for (size_t k = 0; k < layout.digits1; k++) {
+            shuffle[8 - layout.digits1 + k] = static_cast<uint8_t>(k);
+        }
+        for (size_t k = 0; k < layout.digits2; k++) {
+            shuffle[16 - layout.digits2 + k] = static_cast<uint8_t>(layout.start2 + k);
+        }
+        shuffle_ = _mm_load_si128(reinterpret_cast<const __m128i*>(shuffle));
+        digitMask_ = _mm_load_si128(reinterpret_cast<const __m128i*>(digitMask));
+        literals_ = _mm_load_si128(reinterpret_cast<const __m128i*>(literals));
+        literalMask_ = _mm_load_si128(reinterpret_cast<const __m128i*>(literalMask));
+    }
+
+    /**
+     * Parses one record. At least 16 bytes must be readable from record.
+     *
+     * @return True if the record matched the layout, false otherwise.
+     */
+    bool parse(const char* record, int& item1, int& item2) const {
+        __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(record));
+        __m128i digits = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+        __m128i isDigit = _mm_cmpeq_epi8(_mm_min_epu8(digits, _mm_set1_epi8(9)), digits);
+        __m128i isLiteral = _mm_cmpeq_epi8(chars, literals_);
+        __m128i ignored = _mm_cmpeq_epi8(_mm_or_si128(digitMask_, literalMask_), _mm_setzero_si128());
+        __m128i valid = _mm_or_si128(_mm_or_si128(_mm_and_si128(isDigit, digitMask_),
+                                                  _mm_and_si128(isLiteral, literalMask_)),
+                                     ignored);
+        if (_mm_movemask_epi8(valid) != 0xFFFF) {
+            return false;
+        }
+
+        __m128i aligned = _mm_shuffle_epi8(digits, shuffle_);
+        __m128i pairs = _mm_maddubs_epi16(aligned, _mm_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1));
+        __m128i quads = _mm_madd_epi16(pairs, _mm_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1));
+        __m128i packed = _mm_packus_epi32(quads, quads);
+        __m128i values = _mm_madd_epi16(packed, _mm_setr_epi16(10000, 1, 10000, 1, 10000, 1, 10000, 1));
+        item1 = _mm_cvtsi128_si32(values);
+        item2 = _mm_extract_epi32(values, 1);
+        return true;
+    }
+
+private:
+    __m128i shuffle_;
+    __m128i digitMask_;
+    __m128i literals_;
+    __m128i literalMask_;
+};
+#endif
+
+/**
+ * Parses a buffer holding two whitespace-separated integer columns into two lists.
+ * When the first line has a fixed-width layout, records are parsed with SIMD where available;
+ * lines that do not match the layout fall back to the scalar line parser.
+ *
+ * @param data The file contents.
+ * @param size The number of bytes in data.
+ * @param list1 A reference to the first list to store the data.
+ * @param list2 A reference to the second list to store the data.
+ * @return True if every line held two integers, false otherwise.
+ */
+bool parseIntoLists(const char* data, size_t size, std::vector<int>& list1, std::vector<int>& list2) {
+    RecordLayout layout;
+    bool fixedWidth = detectRecordLayout(data, size, layout);
+    if (fixedWidth) {
+        list1.reserve(size / layout.width + 1);
+        list2.reserve(size / layout.width + 1);
+    }
+
+    size_t pos = 0;
+    int item1, item2;
+#if defined(__SSE4_1__)
+    if (fixedWidth) {
+        FixedWidthParser parser(layout);
+        while (pos + 16 <= size) {
+            if (parser.parse(data + pos, item1, item2)) {
+                pos += layout.width;
+            } else if (!parseLine(data, size, pos, item1, item2)) {
+                return false;
+            }
+            list1.push_back(item1);
+            list2.push_back(item2);
+        }
+    }
+#endif
+    // Parse the remaining lines one at a time
+    while (pos < size) {
+        if (!parseLine(data, size, pos, item1, item2)) {
+            return false;
+        }
+        list1.push_back(item1);
+        list2.push_back(item2);
+    }
+    return true;
+}
+
+/**
+ * Reads a file with two whitespace-separated integer columns into two lists.
+ * Regular files are memory-mapped and parsed in place. Pipes and other files that cannot be
+ * mapped are read into a buffer first.
  *
  * @param filename The name of the file to read.
  * @param list1 A reference to the first list to store the data.
  * @param list2 A reference to the second list to store the data.
  * @return True if the file was read successfully, false otherwise.
  */
-bool readFileIntoLists(const std::string& filename, std::vector<std::string>& list1, std::vector<std::string>& list2) {
+bool readFileIntoLists(const std::string& filename, std::vector<int>& list1, std::vector<int>& list2) {
     // Open the file
-    std::ifstream file(filename);
-    if (!file.is_open()) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
         std::cerr << "Unable to open file " << filename << std::endl;
         return false;
     }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        std::cerr << "Unable to open file " << filename << std::endl;
+        close(fd);
+        return false;
+    }
 
-    // Read the file line by line
-    std::string line;
-    while (std::getline(file, line)) {
-        std::istringstream iss(line);
-        std::string item1, item2;
-
-        // Read two tab-separated items
-        if (std::getline(iss, item1, ' ') && std::getline(iss, item2)) {
-            item2.erase(0, item2.find_first_not_of(' ')); // Strip leading spaces from item2
-            list1.push_back(item1);
-            list2.push_back(item2);
-        } else {
-            std::cerr << "Invalid line format in file " << filename << std::endl;
-            file.close();
+    bool valid;
+    if (S_ISREG(st.st_mode)) {
+        // Map the file
+        size_t size = static_cast<size_t>(st.st_size);
+        if (size == 0) {
+            close(fd);
+            return true;
+        }
+        void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (mapping == MAP_FAILED) {
+            std::cerr << "Unable to map file " << filename << std::endl;
+            return false;
+        }
+        madvise(mapping, size, MADV_SEQUENTIAL);
+        valid = parseIntoLists(static_cast<const char*>(mapping), size, list1, list2);
+        munmap(mapping, size);
+    } else {
+        // Read until the end of the stream
+        std::vector<char> buffer;
+        size_t size = 0;
+        ssize_t bytes;
+        do {
+            buffer.resize(std::max<size_t>(buffer.size() * 2, 1 << 16));
+            while ((bytes = read(fd, buffer.data() + size, buffer.size() - size)) > 0) {
+                size += bytes;
+                if (size == buffer.size()) {
+                    break;
+                }
+            }
+        } while (bytes > 0);
+        close(fd);
+        if (bytes < 0) {
+            std::cerr << "Unable to read file " << filename << std::endl;
             return false;
         }
+        valid = parseIntoLists(buffer.data(), size, list1, list2);
     }
 
-    // Close the file
-    file.close();
+    if (!valid) {
+        std::cerr << "Invalid line format in file " << filename << std::endl;
+        return false;
+    }
 
     return true;
 }
 
 /**
- * Sorts the contents of a list in ascending order.
- * 
+ * Sorts the contents of a list in ascending order using an LSD radix sort over the
+ * four bytes of each value. Lists shorter than the threshold use std::sort instead,
+ * since the counting passes only pay off on larger inputs.
+ *
  * @param list The list to sort.
+ * @param threshold The list size below which a comparison sort is used.
  */
-void bubbleSort(std::vector<std::string>& list) {
-    for (int i = 0; i < list.size() - 1; i++) {
-        for (int j = 0; j < list.size() - i - 1; j++) {
-            if (list[j] > list[j + 1]) {
-                std::swap(list[j], list[j + 1]);
-            }
+void radixSort(std::vector<int>& list, size_t threshold = 256) {
+    if (list.size() < threshold) {
+        std::sort(list.begin(), list.end());
+        return;
+    }
+
+    // Flip the sign bit so that negative values order before positive ones as unsigned keys
+    std::vector<uint32_t> keys(list.size());
+    for (size_t i = 0; i < list.size(); i++) {
+        keys[i] = static_cast<uint32_t>(list[i]) ^ 0x80000000u;
+    }
+    std::vector<uint32_t> buffer(keys.size());
+
+    for (int shift = 0; shift < 32; shift += 8) {
+        // Count the occurrences of each byte value
+        size_t counts[256] = {0};
+        for (uint32_t key : keys) {
+            counts[(key >> shift) & 0xFF]++;
         }
+        // Skip the pass if every key has the same byte here
+        if (counts[(keys[0] >> shift) & 0xFF] == keys.size()) {
+            continue;
+        }
+        // Turn the counts into starting offsets
+        size_t offset = 0;
+        for (size_t& count : counts) {
+            size_t next = offset + count;
+            count = offset;
+            offset = next;
+        }
+        // Scatter the keys into the buffer in stable order
+        for (uint32_t key : keys) {
+            buffer[counts[(key >> shift) & 0xFF]++] = key;
+        }
+        keys.swap(buffer);
+    }
+
+    for (size_t i = 0; i < list.size(); i++) {
+        list[i] = static_cast<int>(keys[i] ^ 0x80000000u);
     }
 }
 
@@ -66,51 +356,850 @@ void bubbleSort(std::vector<std::string>& list) {
  * @param list2 The second list.
  * @return The sum of the absolute differences between the items at each index of the two lists.
  */
-int getAbsoluteDifferences(const std::vector<std::string>& list1, const std::vector<std::string>& list2) {
-    int differences = 0;
+int64_t getAbsoluteDifferences(const std::vector<int>& list1, const std::vector<int>& list2) {
+    int64_t differences = 0;
     // verify the two lists are the same size
     if (list1.size() != list2.size()) {
         std::cerr << "The two lists are not the same size." << std::endl;
         return 0;
     }
-    for (int i = 0; i < list1.size(); i++) {
-        int item1 = std::stoi(list1[i]);
-        int item2 = std::stoi(list2[i]);
-        differences += std::abs(item1 - item2);
+    for (size_t i = 0; i < list1.size(); i++) {
+        differences += std::abs(static_cast<int64_t>(list1[i]) - list2[i]);
     }
     return differences;
 }
 
+/**
+ * Gets the similarity of two sorted ranges with a merge-join: each run of equal values on the left
+ * is matched against the run of the same value on the right, contributing value * leftRun * rightRun.
+ * 
+ * @param list1 The left range, sorted in ascending order.
+ * @param size1 The number of items in the left range.
+ * @param list2 The right range, sorted in ascending order.
+ * @param size2 The number of items in the right range.
+ * @return The similarity of the two ranges.
+ */
+int64_t getSimilarity(const int* list1, size_t size1, const int* list2, size_t size2) {
+    int64_t similarity = 0;
+    size_t i = 0;
+    size_t j = 0;
+    while (i < size1 && j < size2) {
+        if (list1[i] < list2[j]) {
+            i++;
+        } else if (list2[j] < list1[i]) {
+            j++;
+        } else {
+            // measure the run of this value in both lists
+            int value = list1[i];
+            size_t leftRun = 0;
+            while (i < size1 && list1[i] == value) {
+                leftRun++;
+                i++;
+            }
+            size_t rightRun = 0;
+            while (j < size2 && list2[j] == value) {
+                rightRun++;
+                j++;
+            }
+            similarity += static_cast<int64_t>(value) * static_cast<int64_t>(leftRun * rightRun);
+        }
+    }
+
+    return similarity;
+}
+
 /**
  * Gets the similarity by adding up each number in the left list after multiplying it by the number of times that number appears in the right list.
+ * Both lists are walked once as a merge-join over runs of equal values.
  * 
  * @param list1 The left list, sorted in ascending order.
  * @param list2 The right list, sorted in ascending order.
  * @return The similarity.
  */
-int getSimilarity(const std::vector<std::string>& list1, const std::vector<std::string>& list2) {
-    int similarity = 0;
-    // interate through the left list
-    for (int i = 0; i < list1.size(); i++) {
-        int item1 = std::stoi(list1[i]);
-        int count = 0;
-        // iterate through the right list
-        for (int j = 0; j < list2.size(); j++) {
-            int item2 = std::stoi(list2[j]);
-            if (item1 == item2) {
-                count++;
-            }
-            // break if the item in the right list is greater than the item in the left list
-            if (item2 > item1) {
-                break;
+int64_t getSimilarity(const std::vector<int>& list1, const std::vector<int>& list2) {
+    return getSimilarity(list1.data(), list1.size(), list2.data(), list2.size());
+}
+
+/**
+ * Gets the similarity of two lists that are not sorted, by building a histogram of the right list
+ * and probing it once for each item in the left list.
+ * 
+ * @param list1 The left list, in any order.
+ * @param list2 The right list, in any order.
+ * @return The similarity.
+ */
+int64_t getSimilarityUnsorted(const std::vector<int>& list1, const std::vector<int>& list2) {
+    std::unordered_map<int, int64_t> counts;
+    counts.reserve(list2.size());
+    for (int item : list2) {
+        counts[item]++;
+    }
+
+    int64_t similarity = 0;
+    for (int item : list1) {
+        auto it = counts.find(item);
+        if (it != counts.end()) {
+            similarity += static_cast<int64_t>(item) * it->second;
+        }
+    }
+
+    return similarity;
+}
+
+
+/**
+ * Runs a task once for each worker index on its own thread and waits for all of them.
+ *
+ * @param threads The number of workers.
+ * @param task The task to run, called with the worker index.
+ */
+template <typename Task>
+void runWorkers(unsigned threads, const Task& task) {
+    std::vector<std::future<void>> futures;
+    for (unsigned t = 0; t < threads; t++) {
+        futures.push_back(std::async(std::launch::async, task, t));
+    }
+    for (auto& future : futures) {
+        future.get();
+    }
+}
+
+/**
+ * Sorts a list in ascending order with a parallel LSD radix sort. Each worker counts the bytes
+ * of its own slice, the counts are turned into per-worker offsets, and each worker scatters its
+ * slice into place, so every pass stays stable.
+ *
+ * @param list The list to sort.
+ * @param threads The number of workers to use.
+ */
+void parallelRadixSort(std::vector<int>& list, unsigned threads) {
+    if (threads <= 1 || list.size() < 65536) {
+        radixSort(list);
+        return;
+    }
+
+    size_t size = list.size();
+    std::vector<uint32_t> keys(size);
+    std::vector<uint32_t> buffer(size);
+    auto sliceBegin = [size, threads](unsigned t) { return size * t / threads; };
+    runWorkers(threads, [&](unsigned t) {
+        for (size_t i = sliceBegin(t); i < sliceBegin(t + 1); i++) {
+            keys[i] = static_cast<uint32_t>(list[i]) ^ 0x80000000u;
+        }
+    });
+
+    std::vector<std::array<size_t, 256>> counts(threads);
+    for (int shift = 0; shift < 32; shift += 8) {
+        // Count the occurrences of each byte value in every slice
+        runWorkers(threads, [&](unsigned t) {
+            counts[t].fill(0);
+            for (size_t i = sliceBegin(t); i < sliceBegin(t + 1); i++) {
+                counts[t][(keys[i] >> shift) & 0xFF]++;
+            }
+        });
+        // Skip the pass if every key has the same byte here
+        size_t first = (keys[0] >> shift) & 0xFF;
+        size_t firstTotal = 0;
+        for (unsigned t = 0; t < threads; t++) {
+            firstTotal += counts[t][first];
+        }
+        if (firstTotal == size) {
+            continue;
+        }
+        // Turn the counts into starting offsets, ordered by byte value and then by slice
+        size_t offset = 0;
+        for (size_t digit = 0; digit < 256; digit++) {
+            for (unsigned t = 0; t < threads; t++) {
+                size_t next = offset + counts[t][digit];
+                counts[t][digit] = offset;
+                offset = next;
             }
         }
-        similarity += item1 * count;
+        // Scatter each slice into the buffer
+        runWorkers(threads, [&](unsigned t) {
+            for (size_t i = sliceBegin(t); i < sliceBegin(t + 1); i++) {
+                buffer[counts[t][(keys[i] >> shift) & 0xFF]++] = keys[i];
+            }
+        });
+        keys.swap(buffer);
+    }
+
+    runWorkers(threads, [&](unsigned t) {
+        for (size_t i = sliceBegin(t); i < sliceBegin(t + 1); i++) {
+            list[i] = static_cast<int>(keys[i] ^ 0x80000000u);
+        }
+    });
+}
+
+/**
+ * Sorts both lists at the same time, splitting the workers between them.
+ *
+ * @param list1 The first list to sort.
+ * @param list2 The second list to sort.
+ * @param threads The total number of workers to use.
+ */
+void parallelSortLists(std::vector<int>& list1, std::vector<int>& list2, unsigned threads) {
+    unsigned threads1 = std::max(threads / 2, 1u);
+    unsigned threads2 = std::max(threads - threads1, 1u);
+    std::future<void> sort1 = std::async(std::launch::async, [&]() { parallelRadixSort(list1, threads1); });
+    parallelRadixSort(list2, threads2);
+    sort1.get();
+}
+
+/**
+ * Gets the sum of the absolute differences with each worker summing its own slice of the lists.
+ *
+ * @param list1 The first list.
+ * @param list2 The second list.
+ * @param threads The number of workers to use.
+ * @return The sum of the absolute differences between the items at each index of the two lists.
+ */
+int64_t getAbsoluteDifferencesParallel(const std::vector<int>& list1, const std::vector<int>& list2, unsigned threads) {
+    if (list1.size() != list2.size()) {
+        std::cerr << "The two lists are not the same size." << std::endl;
+        return 0;
+    }
+    size_t size = list1.size();
+    std::vector<int64_t> partials(threads, 0);
+    runWorkers(threads, [&](unsigned t) {
+        int64_t differences = 0;
+        for (size_t i = size * t / threads; i < size * (t + 1) / threads; i++) {
+            differences += std::abs(static_cast<int64_t>(list1[i]) - list2[i]);
+        }
+        partials[t] = differences;
+    });
+
+    int64_t differences = 0;
+    for (int64_t partial : partials) {
+        differences += partial;
+    }
+    return differences;
+}
+
+/**
+ * Gets the similarity of two sorted lists with each worker merge-joining its own slice.
+ * The left list is split on value boundaries so that no run of equal values straddles two slices,
+ * and each slice is joined against the range of the right list holding the same values.
+ *
+ * @param list1 The left list, sorted in ascending order.
+ * @param list2 The right list, sorted in ascending order.
+ * @param threads The number of workers to use.
+ * @return The similarity.
+ */
+int64_t getSimilarityParallel(const std::vector<int>& list1, const std::vector<int>& list2, unsigned threads) {
+    // Move each split point forward to the start of a run
+    std::vector<size_t> bounds(threads + 1);
+    for (unsigned t = 0; t <= threads; t++) {
+        size_t bound = list1.size() * t / threads;
+        if (t > 0) {
+            bound = std::max(bound, bounds[t - 1]);
+        }
+        while (bound > 0 && bound < list1.size() && list1[bound] == list1[bound - 1]) {
+            bound++;
+        }
+        bounds[t] = bound;
     }
 
+    std::vector<int64_t> partials(threads, 0);
+    runWorkers(threads, [&](unsigned t) {
+        size_t begin1 = bounds[t];
+        size_t end1 = bounds[t + 1];
+        if (begin1 == end1) {
+            return;
+        }
+        auto begin2 = std::lower_bound(list2.begin(), list2.end(), list1[begin1]);
+        auto end2 = end1 == list1.size() ? list2.end() : std::lower_bound(begin2, list2.end(), list1[end1]);
+        // The slice may lie above every right value, leaving begin2 at the end of the list
+        partials[t] = getSimilarity(list1.data() + begin1, end1 - begin1,
+                                    list2.data() + (begin2 - list2.begin()), end2 - begin2);
+    });
+
+    int64_t similarity = 0;
+    for (int64_t partial : partials) {
+        similarity += partial;
+    }
     return similarity;
 }
 
+/**
+ * Sorted runs of one column, stored back to back in a single temporary file so that the number
+ * of open files does not grow with the number of runs.
+ */
+struct RunFile {
+    /**
+     * A run, as the offset of its first value and its number of values.
+     */
+    struct Run {
+        uint64_t offset;
+        uint64_t count;
+    };
+
+    std::FILE* file = nullptr;
+    uint64_t size = 0;
+    std::vector<Run> runs;
+
+    RunFile() = default;
+    RunFile(const RunFile&) = delete;
+    RunFile& operator=(const RunFile&) = delete;
+    ~RunFile() { close(); }
+
+    void close() {
+        if (file != nullptr) {
+            std::fclose(file);
+            file = nullptr;
+        }
+        size = 0;
+        runs.clear();
+    }
+
+    void swap(RunFile& other) {
+        std::swap(file, other.file);
+        std::swap(size, other.size);
+        runs.swap(other.runs);
+    }
+};
+
+/**
+ * Creates an anonymous temporary file for spilled runs in $TMPDIR, or /tmp when it is not set.
+ * The file is unlinked straight away, so it is removed once closed even if the program stops early.
+ * Point $TMPDIR at a disk rather than a tmpfs so that spilled runs do not end up back in memory.
+ *
+ * @return The opened file, or nullptr if it could not be created.
+ */
+std::FILE* createSpillFile() {
+    const char* dir = std::getenv("TMPDIR");
+    std::string path = std::string(dir != nullptr && *dir != '\0' ? dir : "/tmp") + "/aoc-runs-XXXXXX";
+    int fd = mkstemp(&path[0]);
+    if (fd < 0) {
+        return nullptr;
+    }
+    unlink(path.c_str());
+    std::FILE* file = fdopen(fd, "w+b");
+    if (file == nullptr) {
+        close(fd);
+    }
+    return file;
+}
+
+/**
+ * Appends values to the end of a run file, creating the temporary file on first use.
+ * The values become part of the last run, which the caller starts.
+ *
+ * @param values The values to append.
+ * @param count The number of values.
+ * @param runs The run file to append to.
+ * @return True if the values were written successfully, false otherwise.
+ */
+bool appendToRunFile(const int* values, size_t count, RunFile& runs) {
+    if (runs.file == nullptr) {
+        runs.file = createSpillFile();
+    }
+    if (runs.file == nullptr || fseeko(runs.file, static_cast<off_t>(runs.size * sizeof(int)), SEEK_SET) != 0 ||
+        std::fwrite(values, sizeof(int), count, runs.file) != count) {
+        std::cerr << "Unable to write temporary run file" << std::endl;
+        return false;
+    }
+    runs.size += count;
+    runs.runs.back().count += count;
+    return true;
+}
+
+/**
+ * Sorts a column chunk and spills it to the column's run file as one sorted run.
+ *
+ * @param column The chunk to spill. It is cleared afterwards.
+ * @param runs A reference to the run file to append to.
+ * @return True if the run was written successfully, false otherwise.
+ */
+bool spillRun(std::vector<int>& column, RunFile& runs) {
+    if (column.empty()) {
+        return true;
+    }
+    radixSort(column);
+    runs.runs.push_back({runs.size, 0});
+    if (!appendToRunFile(column.data(), column.size(), runs)) {
+        return false;
+    }
+    column.clear();
+    return true;
+}
+
+/**
+ * Streams a two-column file in fixed-size blocks and spills each column as sorted runs
+ * of at most chunkItems values.
+ *
+ * @param filename The name of the file to read.
+ * @param chunkItems The number of rows to buffer before spilling a run.
+ * @param runs1 A reference to the run file for the first column.
+ * @param runs2 A reference to the run file for the second column.
+ * @return True if the file was read and spilled successfully, false otherwise.
+ */
+bool spillSortedRuns(const std::string& filename, size_t chunkItems, RunFile& runs1, RunFile& runs2) {
+    std::FILE* file = std::fopen(filename.c_str(), "rb");
+    if (file == nullptr) {
+        std::cerr << "Unable to open file " << filename << std::endl;
+        return false;
+    }
+
+    std::vector<int> column1;
+    std::vector<int> column2;
+    column1.reserve(chunkItems);
+    column2.reserve(chunkItems);
+
+    // Read fixed-size blocks, parse the complete lines and carry the partial last line over.
+    // A failed spill has already been reported, so it is kept apart from a bad line.
+    std::vector<char> buffer(1 << 16);
+    size_t filled = 0;
+    bool valid = true;
+    bool spilled = true;
+    bool done = false;
+    while (valid && spilled && !done) {
+        size_t bytes = std::fread(buffer.data() + filled, 1, buffer.size() - filled, file);
+        filled += bytes;
+        done = bytes == 0;
+        size_t end = filled;
+        if (!done) {
+            while (end > 0 && buffer[end - 1] != '\n') {
+                end--;
+            }
+            if (end == 0) {
+                if (filled == buffer.size()) {
+                    valid = false;
+                }
+                continue;
+            }
+        }
+
+        size_t pos = 0;
+        int item1, item2;
+        while (pos < end) {
+            if (!parseLine(buffer.data(), end, pos, item1, item2)) {
+                valid = false;
+                break;
+            }
+            column1.push_back(item1);
+            column2.push_back(item2);
+            if (column1.size() == chunkItems) {
+                spilled = spillRun(column1, runs1) && spillRun(column2, runs2);
+                if (!spilled) {
+                    break;
+                }
+            }
+        }
+        std::copy(buffer.begin() + end, buffer.begin() + filled, buffer.begin());
+        filled -= end;
+    }
+    std::fclose(file);
+
+    if (!spilled) {
+        return false;
+    }
+    if (!valid) {
+        std::cerr << "Invalid line format in file " << filename << std::endl;
+        return false;
+    }
+    return spillRun(column1, runs1) && spillRun(column2, runs2);
+}
+
+/**
+ * K-way merge over sorted runs of a run file, reading each run through a small buffer.
+ * Values come out in ascending order, one at a time.
+ */
+class RunMerger {
+public:
+    /**
+     * @param file The run file holding the runs.
+     * @param first The index of the first run to merge.
+     * @param count The number of runs to merge.
+     * @param bufferItems The number of values to buffer per run.
+     */
+    RunMerger(const RunFile& file, size_t first, size_t count, size_t bufferItems)
+        : file_(file.file), cursors_(count) {
+        for (size_t i = 0; i < count; i++) {
+            cursors_[i].offset = file.runs[first + i].offset;
+            cursors_[i].remaining = file.runs[first + i].count;
+            cursors_[i].buffer.resize(bufferItems);
+            if (refill(cursors_[i])) {
+                heap_.push({cursors_[i].buffer[0], i});
+            }
+        }
+    }
+
+    /**
+     * Gets the next smallest value across all runs.
+     *
+     * @param value A reference to store the value.
+     * @return True if a value was produced, false once every run is exhausted.
+     */
+    bool next(int& value) {
+        if (heap_.empty()) {
+            return false;
+        }
+        size_t run = heap_.top().second;
+        heap_.pop();
+        Cursor& cursor = cursors_[run];
+        value = cursor.buffer[cursor.pos++];
+        if (cursor.pos < cursor.count || refill(cursor)) {
+            heap_.push({cursor.buffer[cursor.pos], run});
+        }
+        return true;
+    }
+
+private:
+    struct Cursor {
+        uint64_t offset = 0;
+        uint64_t remaining = 0;
+        std::vector<int> buffer;
+        size_t pos = 0;
+        size_t count = 0;
+    };
+
+    // The runs share one file, so each refill seeks to where its run left off
+    bool refill(Cursor& cursor) {
+        size_t wanted = static_cast<size_t>(std::min<uint64_t>(cursor.buffer.size(), cursor.remaining));
+        cursor.count = 0;
+        if (wanted > 0 && fseeko(file_, static_cast<off_t>(cursor.offset * sizeof(int)), SEEK_SET) == 0) {
+            cursor.count = std::fread(cursor.buffer.data(), sizeof(int), wanted, file_);
+        }
+        cursor.offset += cursor.count;
+        cursor.remaining -= cursor.count;
+        cursor.pos = 0;
+        return cursor.count > 0;
+    }
+
+    std::FILE* file_;
+    std::vector<Cursor> cursors_;
+    std::priority_queue<std::pair<int, size_t>, std::vector<std::pair<int, size_t>>, std::greater<std::pair<int, size_t>>> heap_;
+};
+
+/**
+ * Merges the runs of a run file, at most fanIn at a time, into a new run file with fewer and longer runs,
+ * repeating until no more than fanIn runs are left.
+ *
+ * @param runs A reference to the run file, replaced by the merged one.
+ * @param fanIn The largest number of runs to merge at once, at least 2.
+ * @param bufferItems The number of values to buffer per run, and for the output.
+ * @return True if the runs were merged successfully, false otherwise.
+ */
+bool mergeRunsDown(RunFile& runs, size_t fanIn, size_t bufferItems) {
+    std::vector<int> output;
+    output.reserve(bufferItems);
+    while (runs.runs.size() > fanIn) {
+        RunFile merged;
+        for (size_t first = 0; first < runs.runs.size(); first += fanIn) {
+            size_t count = std::min(fanIn, runs.runs.size() - first);
+            RunMerger merger(runs, first, count, bufferItems);
+            merged.runs.push_back({merged.size, 0});
+            int value;
+            while (merger.next(value)) {
+                output.push_back(value);
+                if (output.size() == bufferItems) {
+                    if (!appendToRunFile(output.data(), output.size(), merged)) {
+                        return false;
+                    }
+                    output.clear();
+                }
+            }
+            if (!output.empty()) {
+                if (!appendToRunFile(output.data(), output.size(), merged)) {
+                    return false;
+                }
+                output.clear();
+            }
+        }
+        runs.swap(merged);
+    }
+    return true;
+}
+
+/**
+ * Computes the sum of absolute differences and the similarity of a file that may not fit in memory.
+ * Each column is spilled to a temporary file as sorted runs, and the runs are then k-way merged:
+ * once pairing the two columns index by index for the differences, and once as a merge-join for the similarity.
+ * The budget covers the chunk buffers and radix sort scratch while spilling, and the run buffers while merging.
+ * When there are too many runs to give each a buffer of at least 4 KiB within the budget, they are first
+ * merged in several passes into fewer, longer runs. At least two runs are always merged at once, so very small
+ * budgets are exceeded by a few buffers. Runs are spilled under $TMPDIR.
+ *
+ * @param filename The name of the file to read.
+ * @param budgetBytes The memory budget in bytes.
+ * @param differences A reference to store the sum of the absolute differences.
+ * @param similarity A reference to store the similarity.
+ * @return True if the file was processed successfully, false otherwise.
+ */
+bool getExternalScores(const std::string& filename, size_t budgetBytes, int64_t& differences, int64_t& similarity) {
+    // Both columns are buffered while spilling, and radix sort needs two more arrays of the same size
+    size_t chunkItems = std::max<size_t>(budgetBytes / (4 * sizeof(int)), 1024);
+
+    RunFile runs1;
+    RunFile runs2;
+    bool valid = spillSortedRuns(filename, chunkItems, runs1, runs2);
+
+    // Two mergers are open at a time at the end, each with one buffer of at least minBufferItems per run
+    const size_t minBufferItems = 1024;
+    size_t fanIn = std::max<size_t>(budgetBytes / (2 * sizeof(int) * minBufferItems), 2);
+    if (valid) {
+        // A pass merges one column at a time, with one buffer per run plus one for the output
+        size_t passBufferItems = std::max<size_t>(budgetBytes / (sizeof(int) * (fanIn + 1)), minBufferItems);
+        valid = mergeRunsDown(runs1, fanIn, passBufferItems) && mergeRunsDown(runs2, fanIn, passBufferItems);
+    }
+
+    if (valid) {
+        size_t mergedRuns = std::max<size_t>({runs1.runs.size(), runs2.runs.size(), 1});
+        size_t bufferItems = std::max<size_t>(budgetBytes / (2 * sizeof(int) * mergedRuns), minBufferItems);
+
+        // Pair the columns index by index
+        differences = 0;
+        {
+            RunMerger merger1(runs1, 0, runs1.runs.size(), bufferItems);
+            RunMerger merger2(runs2, 0, runs2.runs.size(), bufferItems);
+            int item1, item2;
+            bool has1 = merger1.next(item1);
+            bool has2 = merger2.next(item2);
+            while (has1 && has2) {
+                differences += std::abs(static_cast<int64_t>(item1) - item2);
+                has1 = merger1.next(item1);
+                has2 = merger2.next(item2);
+            }
+            if (has1 || has2) {
+                std::cerr << "The two lists are not the same size." << std::endl;
+                valid = false;
+            }
+        }
+
+        // Join the runs of equal values
+        similarity = 0;
+        if (valid) {
+            RunMerger merger1(runs1, 0, runs1.runs.size(), bufferItems);
+            RunMerger merger2(runs2, 0, runs2.runs.size(), bufferItems);
+            int item1, item2;
+            bool has1 = merger1.next(item1);
+            bool has2 = merger2.next(item2);
+            while (has1 && has2) {
+                if (item1 < item2) {
+                    has1 = merger1.next(item1);
+                } else if (item2 < item1) {
+                    has2 = merger2.next(item2);
+                } else {
+                    int value = item1;
+                    int64_t leftRun = 0;
+                    int64_t rightRun = 0;
+                    while (has1 && item1 == value) {
+                        leftRun++;
+                        has1 = merger1.next(item1);
+                    }
+                    while (has2 && item2 == value) {
+                        rightRun++;
+                        has2 = merger2.next(item2);
+                    }
+                    similarity += static_cast<int64_t>(value) * leftRun * rightRun;
+                }
+            }
+        }
+    }
+
+    return valid;
+}
+
+/**
+ * Keeps the sum of absolute differences and the similarity up to date as pairs are appended,
+ * without re-sorting the lists.
+ *
+ * For two sorted lists of the same length, the sum of |list1[i] - list2[i]| equals the sum over every
+ * value t of |D(t)|, where D(t) is the number of left items <= t minus the number of right items <= t.
+ * Appending the pair (item1, item2) adds one to D on [item1, item2), or subtracts one on [item2, item1),
+ * so the sum changes by the number of values in that range with D(t) >= 0 minus the number with
+ * D(t) < 0 (the other way round when subtracting). D only changes at values that have been inserted,
+ * so it is kept as a sorted list of segments, one starting at each distinct value seen so far and
+ * weighted by its length. The segments are grouped in blocks of about sqrt(segments), each with a lazy
+ * offset and a histogram of segment weight by value, so a pair costs O(sqrt(distinct values)) and memory
+ * grows with the distinct values rather than their range. Any int can be inserted at any time.
+ * The similarity only needs a map from each value to its count in both lists.
+ */
+class IncrementalScorer {
+public:
+    IncrementalScorer() {
+        // One segment covering every int, and an empty one past the largest, so every split is interior
+        Block block;
+        block.values = {std::numeric_limits<int>::min(), int64_t(std::numeric_limits<int>::max()) + 1};
+        block.raw = {0, 0};
+        block.weights = {block.values[1] - block.values[0], 0};
+        blocks_.push_back(block);
+        rebuild(blocks_[0]);
+        segments_ = 2;
+    }
+
+    /**
+     * Appends a pair of items and updates both totals.
+     *
+     * @param item1 The item appended to the left list.
+     * @param item2 The item appended to the right list.
+     */
+    void insert(int item1, int item2) {
+        // Each new item matches every copy of its value already in the other list
+        auto match2 = counts2_.find(item1);
+        if (match2 != counts2_.end()) {
+            similarity_ += static_cast<int64_t>(item1) * match2->second;
+        }
+        counts1_[item1]++;
+        similarity_ += static_cast<int64_t>(item2) * counts1_[item2];
+        counts2_[item2]++;
+
+        if (item1 != item2) {
+            split(item1);
+            split(item2);
+            int delta = item1 < item2 ? 1 : -1;
+            addRange(locate(std::min(item1, item2)), locate(std::max(item1, item2)), delta);
+        }
+        size_++;
+    }
+
+    int64_t differences() const { return differences_; }
+    int64_t similarity() const { return similarity_; }
+    size_t size() const { return size_; }
+
+private:
+    /**
+     * A run of segments. Segment j starts at values[j], is weights[j] values long and has
+     * D = raw[j] + offset over its whole length.
+     */
+    struct Block {
+        std::vector<int64_t> values;
+        std::vector<int> raw;
+        std::vector<int64_t> weights;
+        int offset = 0;
+        int64_t totalWeight = 0;
+        int64_t nonNegative = 0;
+        std::unordered_map<int, int64_t> histogram;
+    };
+
+    // The block and index of the segment holding a value
+    std::pair<size_t, size_t> locate(int64_t value) const {
+        size_t b = std::upper_bound(blocks_.begin(), blocks_.end(), value,
+                                    [](int64_t v, const Block& block) { return v < block.values.front(); }) -
+                   blocks_.begin() - 1;
+        const std::vector<int64_t>& values = blocks_[b].values;
+        size_t j = std::upper_bound(values.begin(), values.end(), value) - values.begin() - 1;
+        return {b, j};
+    }
+
+    // Starts a new segment at value, splitting the segment that holds it; both halves keep its D
+    void split(int value) {
+        std::pair<size_t, size_t> at = locate(value);
+        Block& block = blocks_[at.first];
+        size_t j = at.second;
+        if (block.values[j] == value) {
+            return;
+        }
+        int64_t end = block.values[j] + block.weights[j];
+        block.weights[j] = value - block.values[j];
+        block.values.insert(block.values.begin() + j + 1, value);
+        block.raw.insert(block.raw.begin() + j + 1, block.raw[j]);
+        block.weights.insert(block.weights.begin() + j + 1, end - value);
+        segments_++;
+
+        // Keep blocks at about sqrt(segments) so that both kinds of update stay balanced
+        size_t target = 32;
+        while (target * target < segments_) {
+            target++;
+        }
+        if (block.values.size() > 2 * target) {
+            Block upper;
+            size_t half = block.values.size() / 2;
+            upper.values.assign(block.values.begin() + half, block.values.end());
+            upper.raw.assign(block.raw.begin() + half, block.raw.end());
+            upper.weights.assign(block.weights.begin() + half, block.weights.end());
+            upper.offset = block.offset;
+            block.values.resize(half);
+            block.raw.resize(half);
+            block.weights.resize(half);
+            rebuild(block);
+            rebuild(upper);
+            blocks_.insert(blocks_.begin() + at.first + 1, std::move(upper));
+        }
+    }
+
+    // Recomputes the totals and histogram of a block from its segments
+    void rebuild(Block& block) {
+        block.totalWeight = 0;
+        block.nonNegative = 0;
+        block.histogram.clear();
+        for (size_t j = 0; j < block.values.size(); j++) {
+            block.totalWeight += block.weights[j];
+            block.histogram[block.raw[j]] += block.weights[j];
+            if (block.raw[j] + block.offset >= 0) {
+                block.nonNegative += block.weights[j];
+            }
+        }
+    }
+
+    int64_t histogramWeight(const Block& block, int raw) const {
+        auto it = block.histogram.find(raw);
+        return it == block.histogram.end() ? 0 : it->second;
+    }
+
+    // Adds delta to D over one segment
+    void addPoint(Block& block, size_t j, int delta) {
+        int64_t weight = block.weights[j];
+        int before = block.raw[j] + block.offset;
+        int after = before + delta;
+        differences_ += weight * (std::abs(after) - std::abs(before));
+        auto it = block.histogram.find(block.raw[j]);
+        if ((it->second -= weight) == 0) {
+            block.histogram.erase(it);
+        }
+        block.raw[j] += delta;
+        block.histogram[block.raw[j]] += weight;
+        if (before >= 0 && after < 0) {
+            block.nonNegative -= weight;
+        } else if (before < 0 && after >= 0) {
+            block.nonNegative += weight;
+        }
+    }
+
+    // Adds delta to D over every segment in a block
+    void addBlock(Block& block, int delta) {
+        if (delta > 0) {
+            // |D + 1| - |D| is +1 for D >= 0 and -1 otherwise
+            differences_ += block.nonNegative - (block.totalWeight - block.nonNegative);
+            block.offset++;
+            block.nonNegative += histogramWeight(block, -block.offset);
+        } else {
+            // |D - 1| - |D| is +1 for D <= 0 and -1 otherwise
+            int64_t positive = block.nonNegative - histogramWeight(block, -block.offset);
+            differences_ += (block.totalWeight - positive) - positive;
+            block.nonNegative = positive;
+            block.offset--;
+        }
+    }
+
+    // Adds delta to D over every segment from begin up to, but not including, end
+    void addRange(std::pair<size_t, size_t> begin, std::pair<size_t, size_t> end, int delta) {
+        if (begin.first == end.first) {
+            for (size_t j = begin.second; j < end.second; j++) {
+                addPoint(blocks_[begin.first], j, delta);
+            }
+            return;
+        }
+        for (size_t j = begin.second; j < blocks_[begin.first].values.size(); j++) {
+            addPoint(blocks_[begin.first], j, delta);
+        }
+        for (size_t b = begin.first + 1; b < end.first; b++) {
+            addBlock(blocks_[b], delta);
+        }
+        for (size_t j = 0; j < end.second; j++) {
+            addPoint(blocks_[end.first], j, delta);
+        }
+    }
+
+    std::vector<Block> blocks_;
+    size_t segments_ = 0;
+    std::unordered_map<int, int64_t> counts1_;
+    std::unordered_map<int, int64_t> counts2_;
+    int64_t differences_ = 0;
+    int64_t similarity_ = 0;
+    size_t size_ = 0;
+};
 
 /**
  * Prints the contents of two lists.
@@ -118,7 +1207,7 @@ int getSimilarity(const std::vector<std::string>& list1, const std::vector<std::
  * @param list1 The first list to print.
  * @param list2 The second list to print.
  */
-void printLists(const std::vector<std::string>& list1, const std::vector<std::string>& list2) {
+void printLists(const std::vector<int>& list1, const std::vector<int>& list2) {
     std::cout << "List 1:" << std::endl;
     int i = 0;
     for (const auto& item : list1) {
@@ -158,34 +1247,76 @@ void printLists(const std::vector<std::string>& list1, const std::vector<std::st
 
 int main(int argc, char* argv[]) {
     // Check if the file name was provided as an argument
-    if (argc != 2) {
-        std::cerr << "Usage: " << argv[0] << " <filename>" << std::endl;
+    std::string mode = argc > 2 ? argv[2] : "";
+    bool valid = argc == 2 ||
+                 (argc == 3 && mode == "--incremental") ||
+                 (argc == 4 && (mode == "--external" || mode == "--parallel"));
+    if (!valid) {
+        std::cerr << "Usage: " << argv[0] << " <filename> [--external <budget MB> | --parallel <threads> | --incremental]" << std::endl;
         return 1;
     }
 
     // Get the file name from the command-line argument
     std::string filename = argv[1];
 
+    // Sort out of core when a memory budget is given
+    if (mode == "--external") {
+        size_t budgetBytes = std::stoul(argv[3]) << 20;
+        int64_t differences = 0;
+        int64_t similarity = 0;
+        if (!getExternalScores(filename, budgetBytes, differences, similarity)) {
+            return 1;
+        }
+        std::cout << "Sum of absolute differences: " << differences << std::endl;
+        std::cout << "Similarity: " << similarity << std::endl;
+        return 0;
+    }
+
+    // Number of workers to sort and reduce with, 1 for the serial path
+    unsigned threads = 1;
+    if (mode == "--parallel") {
+        threads = std::stoul(argv[3]);
+        if (threads == 0) {
+            threads = std::max(std::thread::hardware_concurrency(), 1u);
+        }
+    }
+
     // Vectors to store the lists
-    std::vector<std::string> list1;
-    std::vector<std::string> list2;
+    std::vector<int> list1;
+    std::vector<int> list2;
 
     // Read the file into lists
     if (readFileIntoLists(filename, list1, list2)) {
-        // Print the lists
+        // Replay the pairs one at a time in file order
+        if (mode == "--incremental") {
+            IncrementalScorer scorer;
+            for (size_t i = 0; i < list1.size(); i++) {
+                scorer.insert(list1[i], list2[i]);
+            }
+            std::cout << "Pairs: " << scorer.size() << std::endl;
+            std::cout << "Sum of absolute differences: " << scorer.differences() << std::endl;
+            std::cout << "Similarity: " << scorer.similarity() << std::endl;
+            return 0;
+        }
 
         // Sort the lists
-        bubbleSort(list1);
-        bubbleSort(list2);
+        if (threads > 1) {
+            parallelSortLists(list1, list2, threads);
+        } else {
+            radixSort(list1);
+            radixSort(list2);
+        }
 
         printLists(list1, list2);
 
         // Get the sum of the absolute differences between the items at each index of the two lists
-        int differences = getAbsoluteDifferences(list1, list2);
+        int64_t differences = threads > 1 ? getAbsoluteDifferencesParallel(list1, list2, threads)
+                                          : getAbsoluteDifferences(list1, list2);
         std::cout << "Sum of absolute differences: " << differences << std::endl;
 
         // Get the similarity
-        int similarity = getSimilarity(list1, list2);
+        int64_t similarity = threads > 1 ? getSimilarityParallel(list1, list2, threads)
+                                         : getSimilarity(list1, list2);
         std::cout << "Similarity: " << similarity << std::endl;
     }
 
@@ -1,18 +1,78 @@
 #include <iostream>
 #include <fstream>
-#include <sstream>
 #include <vector>
 #include <string>
+#include <algorithm>
+#include <cstdint>
+#include <atomic>
+#include <future>
+#include <thread>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
 
 /**
- * Reads a file of reports into a nested vector. 
+ * Read-only view of the levels of a single report.
+ */
+struct ReportView {
+    const int* levels;
+    size_t count;
+
+    size_t size() const { return count; }
+    int operator[](size_t i) const { return levels[i]; }
+};
+
+/**
+ * Reports stored in compressed-row form: the levels of every report back to back in one array,
+ * and the offset where each report starts, plus a final offset for the end of the last report.
+ */
+struct ReportStore {
+    std::vector<int> levels;
+    std::vector<size_t> offsets{0};
+
+    size_t size() const { return offsets.size() - 1; }
+    ReportView report(size_t i) const { return {levels.data() + offsets[i], offsets[i + 1] - offsets[i]}; }
+};
+
+/**
+ * Parses the space-separated levels of one line and appends them to a levels array.
+ * 
+ * @param begin The first character of the line.
+ * @param end One past the last character of the line.
+ * @param levels A reference to the array to append the levels to.
+ */
+void appendLevels(const char* begin, const char* end, std::vector<int>& levels) {
+    const char* pos = begin;
+    while (pos < end) {
+        // skip to the start of the next number
+        while (pos < end && *pos != '-' && (*pos < '0' || *pos > '9')) {
+            pos++;
+        }
+        if (pos == end) {
+            break;
+        }
+        bool negative = *pos == '-';
+        if (negative) {
+            pos++;
+        }
+        int value = 0;
+        while (pos < end && *pos >= '0' && *pos <= '9') {
+            value = value * 10 + (*pos - '0');
+            pos++;
+        }
+        levels.push_back(negative ? -value : value);
+    }
+}
+
+/**
+ * Reads a file of reports into a compressed-row report store. 
  * Each report is in a new line, and each report field is an int separated by a space.
  * 
  * @param filename The name of the file to read.
- * @param reports A reference to the vector to store the reports.
+ * @param reports A reference to the store to hold the reports.
  */
 
-bool readFileIntoLists(const std::string& filename, std::vector<std::vector<int>>& reports) {
+bool readFileIntoLists(const std::string& filename, ReportStore& reports) {
     // Open the file
     std::ifstream file(filename);
     if (!file.is_open()) {
@@ -23,13 +83,8 @@ bool readFileIntoLists(const std::string& filename, std::vector<std::vector<int>
     // Read the file line by line
     std::string line;
     while (std::getline(file, line)) {
-        std::istringstream iss(line);
-        std::vector<int> report;
-        int item;
-        while (iss >> item) {
-            report.push_back(item);
-        }
-        reports.push_back(report);
+        appendLevels(line.data(), line.data() + line.size(), reports.levels);
+        reports.offsets.push_back(reports.levels.size());
     }
 
     // Close the file
@@ -44,7 +99,7 @@ bool readFileIntoLists(const std::string& filename, std::vector<std::vector<int>
  * @param report The report to check.
  * @return true if the report is safe, false otherwise.
  */
-bool isSafe(const std::vector<int>& report) {
+bool isSafe(ReportView report) {
     // Check if the levels are increasing or decreasing
     bool increasing = true;
     bool decreasing = true;
@@ -67,78 +122,439 @@ bool isSafe(const std::vector<int>& report) {
     return (increasing || decreasing) && diff;
 }
 
+/**
+ * Helper to check that a step between two adjacent levels goes in the given direction by one to three.
+ * 
+ * @param from The earlier level.
+ * @param to The later level.
+ * @param direction 1 for increasing reports, -1 for decreasing reports.
+ * @return true if the step is valid, false otherwise.
+ */
+bool isValidStep(int from, int to, int direction) {
+    int diff = (to - from) * direction;
+    return diff >= 1 && diff <= 3;
+}
+
+/**
+ * Computes, for every position j of the flat levels array, whether the step from level j - 1 to
+ * level j is a valid increase and whether it is a valid decrease, as one bit per position.
+ * Steps that cross from one report into the next are computed too, but never read.
+ * The deltas are computed 8 (AVX2) or 4 (SSE2) positions at a time, with a scalar loop for the rest.
+ * 
+ * @param levels The flat levels array of a report store.
+ * @param increasing A reference to the bitmap of valid increasing steps.
+ * @param decreasing A reference to the bitmap of valid decreasing steps.
+ */
+void computeStepBitmaps(const std::vector<int>& levels, std::vector<uint64_t>& increasing, std::vector<uint64_t>& decreasing) {
+    size_t count = levels.size();
+    increasing.assign(count / 64 + 1, 0);
+    decreasing.assign(count / 64 + 1, 0);
+    const int* data = levels.data();
+
+    // Vector blocks start at a multiple of the lane count so their bits never straddle two words
+#if defined(__AVX2__)
+    const size_t lanes = 8;
+#elif defined(__SSE2__)
+    const size_t lanes = 4;
+#else
+    const size_t lanes = 1;
+#endif
+    size_t j = 1;
+    for (; j < lanes && j < count; j++) {
+        uint64_t bit = uint64_t(1) << (j & 63);
+        if (isValidStep(data[j - 1], data[j], 1)) {
+            increasing[j >> 6] |= bit;
+        }
+        if (isValidStep(data[j - 1], data[j], -1)) {
+            decreasing[j >> 6] |= bit;
+        }
+    }
+#if defined(__AVX2__)
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i four = _mm256_set1_epi32(4);
+    const __m256i minusFour = _mm256_set1_epi32(-4);
+    for (; j + 8 <= count; j += 8) {
+        __m256i previous = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + j - 1));
+        __m256i current = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + j));
+        __m256i delta = _mm256_sub_epi32(current, previous);
+        __m256i up = _mm256_and_si256(_mm256_cmpgt_epi32(delta, zero), _mm256_cmpgt_epi32(four, delta));
+        __m256i down = _mm256_and_si256(_mm256_cmpgt_epi32(zero, delta), _mm256_cmpgt_epi32(delta, minusFour));
+        increasing[j >> 6] |= uint64_t(_mm256_movemask_ps(_mm256_castsi256_ps(up))) << (j & 63);
+        decreasing[j >> 6] |= uint64_t(_mm256_movemask_ps(_mm256_castsi256_ps(down))) << (j & 63);
+    }
+#elif defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i four = _mm_set1_epi32(4);
+    const __m128i minusFour = _mm_set1_epi32(-4);
+    for (; j + 4 <= count; j += 4) {
+        __m128i previous = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + j - 1));
+        __m128i current = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + j));
+        __m128i delta = _mm_sub_epi32(current, previous);
+        __m128i up = _mm_and_si128(_mm_cmpgt_epi32(delta, zero), _mm_cmpgt_epi32(four, delta));
+        __m128i down = _mm_and_si128(_mm_cmpgt_epi32(zero, delta), _mm_cmpgt_epi32(delta, minusFour));
+        increasing[j >> 6] |= uint64_t(_mm_movemask_ps(_mm_castsi128_ps(up))) << (j & 63);
+        decreasing[j >> 6] |= uint64_t(_mm_movemask_ps(_mm_castsi128_ps(down))) << (j & 63);
+    }
+#endif
+    for (; j < count; j++) {
+        uint64_t bit = uint64_t(1) << (j & 63);
+        if (isValidStep(data[j - 1], data[j], 1)) {
+            increasing[j >> 6] |= bit;
+        }
+        if (isValidStep(data[j - 1], data[j], -1)) {
+            decreasing[j >> 6] |= bit;
+        }
+    }
+}
+
+/**
+ * Helper to check that every bit in [begin, end) of a bitmap is set.
+ * 
+ * @param bits The bitmap to check.
+ * @param begin The first bit to check.
+ * @param end One past the last bit to check.
+ * @return true if all the bits are set, false otherwise.
+ */
+bool allBitsSet(const std::vector<uint64_t>& bits, size_t begin, size_t end) {
+    while (begin < end) {
+        size_t word = begin >> 6;
+        size_t last = std::min(end, (word + 1) << 6);
+        uint64_t width = last - begin;
+        uint64_t mask = (width == 64 ? ~uint64_t(0) : ((uint64_t(1) << width) - 1)) << (begin & 63);
+        if ((bits[word] & mask) != mask) {
+            return false;
+        }
+        begin = last;
+    }
+    return true;
+}
+
+/**
+ * Computes the safety of every report in a store as a bitmap, with bit i set when report i is safe.
+ * The step checks run over the whole flat levels array at once, so short reports are handled
+ * in batches rather than one at a time.
+ * 
+ * @param reports The reports to check.
+ * @param safe A reference to the bitmap of safe reports.
+ */
+void computeSafetyBitmap(const ReportStore& reports, std::vector<uint64_t>& safe) {
+    std::vector<uint64_t> increasing;
+    std::vector<uint64_t> decreasing;
+    computeStepBitmaps(reports.levels, increasing, decreasing);
+
+    safe.assign(reports.size() / 64 + 1, 0);
+    for (size_t i = 0; i < reports.size(); i++) {
+        // the steps of a report end at every level but its first
+        size_t begin = reports.offsets[i] + 1;
+        size_t end = reports.offsets[i + 1];
+        if (begin >= end || allBitsSet(increasing, begin, end) || allBitsSet(decreasing, begin, end)) {
+            safe[i >> 6] |= uint64_t(1) << (i & 63);
+        }
+    }
+}
+
 /** 
  * Determines if a report is to be considered safe. A report is considered safe if both of the following 
  * conditions are met:
  * - The levels are either all increasing or all decreasing.
  * - Any two adjacent levels differ by at least one and at most three.
  * 
- * @param report The report to check.
+ * @param reports The reports to check.
  * @param numSafe The number of safe reports.
- * @return unsafeReports - the nested vector of reports that are not safe
+ * @return unsafeReports - the indices of the reports that are not safe
  */
-std::vector<std::vector<int>> numSafeReports(const std::vector<std::vector<int>>& reports, int& numSafe) {
-    std::vector<std::vector<int>> unsafeReports;
+std::vector<size_t> numSafeReports(const ReportStore& reports, int& numSafe) {
+    std::vector<size_t> unsafeReports;
+    std::vector<uint64_t> safe;
+    computeSafetyBitmap(reports, safe);
     // interate through the reports
-    for (int i = 0; i < reports.size(); i++) {
-        const std::vector<int>& report = reports[i];
-        if (isSafe(report)) {
+    for (size_t i = 0; i < reports.size(); i++) {
+        if ((safe[i >> 6] >> (i & 63)) & 1) {
             numSafe++;
         } else {
-            unsafeReports.push_back(report);
+            unsafeReports.push_back(i);
         } 
     }
     return unsafeReports;
 }
 
 /**
- * Number of safer reports with a report level dampener
- * Report safety follows the same criteria as numSafeReports, but this time we can tolerate a single level that falls outside of the rules
+ * Helper to check that a report is safe in one direction once a single level is skipped.
+ * The levels before skip - 1 are assumed to already be valid, so the scan starts there.
  * 
- * @param unsafeReports The nested vector of reports that are not safe.
- * @param numSafeDampened The number of safe reports with a dampened level.
+ * @param report The report to check.
+ * @param direction 1 for increasing reports, -1 for decreasing reports.
+ * @param skip The index of the level to leave out.
+ * @return true if the remaining levels are safe, false otherwise.
  */
-void numSafeReportsDampened(const std::vector<std::vector<int>>& unsafeReports, int& numSafeDampened) {
-    // iterate through the unsafe reports
-    for (int i = 0; i < unsafeReports.size(); i++) {
-        const std::vector<int>& report = unsafeReports[i];
-        // iterate through the levels of the report
-        for (int j = 0; j < report.size(); j++) {
-            // check the safety of the report with each level removed
-            std::vector<int> reportDampened = report;
-            reportDampened.erase(reportDampened.begin() + j);
-            if (isSafe(reportDampened)) {
-                numSafeDampened++;
+bool isSafeWithout(ReportView report, int direction, size_t skip) {
+    size_t prev = skip == 0 ? 1 : skip - 1;
+    for (size_t i = prev + 1; i < report.size(); i++) {
+        if (i == skip) {
+            continue;
+        }
+        if (!isValidStep(report[prev], report[i], direction)) {
+            return false;
+        }
+        prev = i;
+    }
+    return true;
+}
+
+/**
+ * Helper to check the safety of a single report when one level may be removed.
+ * For each direction, the first invalid step between levels j - 1 and j can only be fixed by
+ * removing one of those two levels, so at most two more linear scans decide the report.
+ * 
+ * @param report The report to check.
+ * @return true if the report is safe with at most one level removed, false otherwise.
+ */
+bool isSafeDampened(ReportView report) {
+    for (int direction : {1, -1}) {
+        // find the first invalid step
+        size_t bad = 1;
+        while (bad < report.size() && isValidStep(report[bad - 1], report[bad], direction)) {
+            bad++;
+        }
+        if (bad >= report.size()) {
+            return true;
+        }
+        if (isSafeWithout(report, direction, bad - 1) || isSafeWithout(report, direction, bad)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Helper to check the safety of a single report when up to a given number of levels may be removed.
+ * For each direction, removals[i] is the fewest levels before i that must be removed for the report to
+ * be safe up to and including level i. Only the previous tolerance + 1 levels can precede a kept level,
+ * so each level looks back at most that far, and the scan stops once tolerance + 1 levels in a row
+ * would each need more removals than allowed.
+ * 
+ * @param report The report to check.
+ * @param tolerance The number of levels that may be removed.
+ * @return true if the report is safe with at most tolerance levels removed, false otherwise.
+ */
+bool isSafeWithTolerance(ReportView report, int tolerance) {
+    size_t n = report.size();
+    size_t k = static_cast<size_t>(std::max(tolerance, 0));
+    if (n <= k + 1) {
+        return true;
+    }
+    // ring buffer of the last k + 2 removal counts
+    std::vector<size_t> removals(k + 2);
+    for (int direction : {1, -1}) {
+        size_t lastWithinTolerance = 0;
+        for (size_t i = 0; i < n; i++) {
+            // removing every level before i always works
+            size_t best = i;
+            for (size_t j = i > k + 1 ? i - k - 1 : 0; j < i; j++) {
+                size_t candidate = removals[j % (k + 2)] + (i - j - 1);
+                if (candidate < best && isValidStep(report[j], report[i], direction)) {
+                    best = candidate;
+                }
+            }
+            removals[i % (k + 2)] = best;
+            if (best <= k) {
+                lastWithinTolerance = i;
+                // the levels after i can all be removed
+                if (best + (n - 1 - i) <= k) {
+                    return true;
+                }
+            } else if (i - lastWithinTolerance > k + 1) {
                 break;
             }
         }
     }
+    return false;
+}
+
+/**
+ * Number of safer reports with a report level dampener
+ * Report safety follows the same criteria as numSafeReports, but this time we can tolerate a number of levels that fall outside of the rules
+ * 
+ * @param reports The reports to check.
+ * @param unsafeReports The indices of the reports that are not safe.
+ * @param numSafeDampened The number of safe reports with dampened levels.
+ * @param tolerance The number of levels that may be removed.
+ */
+void numSafeReportsDampened(const ReportStore& reports, const std::vector<size_t>& unsafeReports, int& numSafeDampened, int tolerance = 1) {
+    // iterate through the unsafe reports
+    for (size_t index : unsafeReports) {
+        ReportView report = reports.report(index);
+        if (tolerance == 1 ? isSafeDampened(report) : isSafeWithTolerance(report, tolerance)) {
+            numSafeDampened++;
+        }
+    }
+}
+
+/**
+ * Counts of reports by safety class.
+ */
+struct ReportCounts {
+    int64_t safe = 0;
+    int64_t dampened = 0;
+    int64_t unsafe = 0;
+};
+
+/**
+ * Classifies every report that starts inside a byte range of the file, reading it line by line.
+ * A report belongs to the range holding its first byte, so a range that starts mid-line skips
+ * ahead to the next line and the last report is read past the end of the range.
+ * 
+ * @param file The open file to read from.
+ * @param start The first byte of the range.
+ * @param end One past the last byte of the range.
+ * @param line A reused buffer for the current line.
+ * @param levels A reused buffer for the levels of the current report.
+ * @param tolerance The number of levels that may be removed.
+ * @param counts A reference to the counts to add to.
+ */
+void classifyChunk(std::ifstream& file, size_t start, size_t end, std::string& line, std::vector<int>& levels, int tolerance, ReportCounts& counts) {
+    file.clear();
+    size_t pos = start;
+    if (start > 0) {
+        // skip the rest of the line that started before the range
+        file.seekg(start - 1);
+        std::getline(file, line);
+        pos = start + line.size();
+    } else {
+        file.seekg(0);
+    }
+
+    while (pos < end && std::getline(file, line)) {
+        pos += line.size() + 1;
+        levels.clear();
+        appendLevels(line.data(), line.data() + line.size(), levels);
+        ReportView report{levels.data(), levels.size()};
+        if (isSafe(report)) {
+            counts.safe++;
+        } else if (tolerance == 1 ? isSafeDampened(report) : isSafeWithTolerance(report, tolerance)) {
+            counts.dampened++;
+        } else {
+            counts.unsafe++;
+        }
+    }
+}
+
+/**
+ * Classifies every report in a file without loading the file. The file is split into fixed-size
+ * chunks, and a pool of workers takes chunks one at a time, parsing and classifying each report
+ * into per-worker counts that are added up at the end. Memory use depends only on the number of
+ * workers and the longest line, not on the size of the file.
+ * 
+ * @param filename The name of the file to read.
+ * @param threads The number of workers to use.
+ * @param tolerance The number of levels that may be removed.
+ * @param counts A reference to store the counts.
+ * @return true if the file was read successfully, false otherwise.
+ */
+bool classifyReportsPipelined(const std::string& filename, unsigned threads, int tolerance, ReportCounts& counts) {
+    std::ifstream probe(filename, std::ios::binary | std::ios::ate);
+    if (!probe.is_open()) {
+        std::cerr << "Unable to open file " << filename << std::endl;
+        return false;
+    }
+    size_t size = static_cast<size_t>(probe.tellg());
+    probe.close();
+
+    const size_t chunkSize = 4 << 20;
+    size_t numChunks = (size + chunkSize - 1) / chunkSize;
+    std::atomic<size_t> nextChunk(0);
+
+    std::vector<std::future<ReportCounts>> futures;
+    for (unsigned t = 0; t < threads; t++) {
+        futures.push_back(std::async(std::launch::async, [&]() -> ReportCounts {
+            ReportCounts local;
+            std::ifstream file(filename, std::ios::binary);
+            std::string line;
+            std::vector<int> levels;
+            for (size_t chunk = nextChunk++; chunk < numChunks; chunk = nextChunk++) {
+                size_t start = chunk * chunkSize;
+                classifyChunk(file, start, std::min(start + chunkSize, size), line, levels, tolerance, local);
+            }
+            return local;
+        }));
+    }
+
+    for (auto& future : futures) {
+        ReportCounts local = future.get();
+        counts.safe += local.safe;
+        counts.dampened += local.dampened;
+        counts.unsafe += local.unsafe;
+    }
+    return true;
 }
 
 /** 
- * Main block. Receives a filename as an argument and reads the file into a nested vector.
+ * Main block. Receives a filename as an argument and reads the file into a report store.
  * 
  * 
  */
 
 int main(int argc, char* argv[]) {
     // Check if the file name was provided as an argument
-    if (argc != 2) {
-        std::cerr << "Usage: " << argv[0] << " <filename>" << std::endl;
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <filename> [--pipeline <threads>] [--tolerance <levels>]" << std::endl;
         return 1;
     }
 
     // Get the file name from the command-line argument
     std::string filename = argv[1];
 
-    // Vector to store the reports
-    std::vector<std::vector<int>> reports;
+    // Number of pipeline workers, 0 to load the file instead
+    unsigned threads = 0;
+    bool pipelined = false;
+
+    // Number of levels the dampener may remove
+    int tolerance = 1;
+    bool toleranceGiven = false;
+
+    // Read the options
+    for (int i = 2; i < argc; i += 2) {
+        std::string option = argv[i];
+        if (i + 1 >= argc || (option != "--pipeline" && option != "--tolerance")) {
+            std::cerr << "Usage: " << argv[0] << " <filename> [--pipeline <threads>] [--tolerance <levels>]" << std::endl;
+            return 1;
+        }
+        if (option == "--pipeline") {
+            pipelined = true;
+            threads = std::stoul(argv[i + 1]);
+        } else {
+            tolerance = std::stoi(argv[i + 1]);
+            toleranceGiven = true;
+        }
+    }
+
+    // Keep the original wording unless a tolerance was asked for
+    std::string dampenedLabel = toleranceGiven ? "Number of safe reports with " + std::to_string(tolerance) + " dampened level(s): "
+                                               : "Number of safe reports with a dampened level: ";
+
+    // Stream the file through a pool of workers instead of loading it
+    if (pipelined) {
+        if (threads == 0) {
+            threads = std::max(std::thread::hardware_concurrency(), 1u);
+        }
+        ReportCounts counts;
+        if (!classifyReportsPipelined(filename, threads, tolerance, counts)) {
+            return 1;
+        }
+        std::cout << "Number of safe reports: " << counts.safe << std::endl;
+        std::cout << dampenedLabel << counts.safe + counts.dampened << std::endl;
+        std::cout << "Number of unsafe reports: " << counts.unsafe << std::endl;
+        return 0;
+    }
+
+    // Store to hold the reports
+    ReportStore reports;
 
     // Integers to store the number of safe reports
     int numSafe = 0;
 
-    // vector of unsafe reports without dampening
-    std::vector<std::vector<int>> unsafeReports;
+    // indices of unsafe reports without dampening
+    std::vector<size_t> unsafeReports;
 
     // Int to store the number of safe reports with dampening
     int numSafeDampened = 0;
@@ -147,9 +563,10 @@ int main(int argc, char* argv[]) {
     if (readFileIntoLists(filename, reports)) {
         // Print the first few reports
         std::cout << "First few reports:" << std::endl;
-        for (int i = 0; i < 5 && i < reports.size(); i++) {
-            for (int j = 0; j < reports[i].size(); j++) {
-                std::cout << reports[i][j] << " ";
+        for (size_t i = 0; i < 5 && i < reports.size(); i++) {
+            ReportView report = reports.report(i);
+            for (size_t j = 0; j < report.size(); j++) {
+                std::cout << report[j] << " ";
             }
             std::cout << std::endl;
         }
@@ -159,8 +576,8 @@ int main(int argc, char* argv[]) {
         std::cout << "Number of safe reports: " << numSafe << std::endl;
 
         // Determine the number of safe reports with a dampened level
-        numSafeReportsDampened(unsafeReports, numSafeDampened);
-        std::cout << "Number of safe reports with a dampened level: " << numSafeDampened + numSafe << std::endl;
+        numSafeReportsDampened(reports, unsafeReports, numSafeDampened, tolerance);
+        std::cout << dampenedLabel << numSafeDampened + numSafe << std::endl;
     }
 
     return 0;
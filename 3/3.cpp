@@ -3,7 +3,17 @@
 #include <sstream>
 #include <vector>
 #include <string>
-#include <regex>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+#include <future>
+#include <thread>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
 
 /**
  * Reads the input file into a single string
@@ -13,104 +23,421 @@
  */
 bool readFileIntoString(const std::string& filename, std::string& input) {
     // Open the file
-    std::ifstream file(filename);
+    std::ifstream file(filename, std::ios::binary);
     if (!file.is_open()) {
         std::cerr << "Unable to open file " << filename << std::endl;
         return false;
     }
-    // Read the file into a string
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    input = buffer.str();
+    // Read a seekable file straight into a string of its final size
+    std::streamoff size = file.seekg(0, std::ios::end) ? static_cast<std::streamoff>(file.tellg()) : -1;
+    if (size >= 0 && file.seekg(0)) {
+        input.resize(static_cast<size_t>(size));
+        file.read(&input[0], input.size());
+    } else {
+        // Pipes cannot seek, so read them to the end instead
+        file.clear();
+        std::ostringstream contents;
+        contents << file.rdbuf();
+        input = contents.str();
+    }
     // Close the file
     file.close();
     return true;
 }
 
 /**
- * Helper to conduct the regex match
- * We are looking for sequences in the string that match mul(<int>, <int>)
- * Where each int as a 1-3 digit number
- * We are also looking for do() and don't() matches
- * @param input The input string to search.
- * @param matches A reference to the vector to store the matches.
- * @param includeDo Flag to include do() matches.
- */
-void findMatches(const std::string& input, std::vector<std::string>& matches, bool includeDo = false) {
-    // Regular expression to match the patterns
-    std::regex pattern; 
-    pattern = "mul\\([0-9]{1,3},[0-9]{1,3}\\)"; 
-    if (includeDo) {
-        pattern = "mul\\([0-9]{1,3},[0-9]{1,3}\\)|do\\(\\)|don't\\(\\)";
-    }
-    // Iterator to search the input string
-    std::sregex_iterator it(input.begin(), input.end(), pattern);
-    std::sregex_iterator end;
-    // Iterate over the matches and store them in the vector
-    while (it != end) {
-        matches.push_back(it->str());
-        ++it;
+ * Kind of instruction recognized in the input
+ */
+enum class OpKind : uint8_t { Mul, Do, Dont };
+
+/**
+ * A recognized instruction: the kind, plus the two operands for mul(a,b)
+ */
+struct Instruction {
+    OpKind kind;
+    int a;
+    int b;
+};
+
+/**
+ * Prints an instruction the way it appears in the input
+ */
+std::ostream& operator<<(std::ostream& out, const Instruction& instruction) {
+    switch (instruction.kind) {
+        case OpKind::Mul:
+            return out << "mul(" << instruction.a << "," << instruction.b << ")";
+        case OpKind::Do:
+            return out << "do()";
+        default:
+            return out << "don't()";
     }
 }
 
 /**
- * Helper to execute a multiplication match
+ * State of the instruction scanner between two bytes.
+ * Each phase names the part of an instruction that has been read so far.
+ */
+struct ScanState {
+    enum Phase : uint8_t {
+        Idle, M, MU, MUL, FirstOperand, SecondOperand,
+        D, DO, DoOpen, DON, DONApos, DONT, DontOpen
+    };
+    Phase phase = Idle;
+    int a = 0;
+    int b = 0;
+    int digits = 0;
+};
+
+/**
+ * Helper to skip the bytes that cannot start an instruction.
+ * Compares 32 (AVX2) or 16 (SSE2) bytes at a time against 'm', and 'd' when do() and don't()
+ * are included, and returns the offset of the first match.
  * 
- * @param match The string that contains the match.
- * @return The result of the multiplication.
- */
-int executeMatch(const std::string& match) {
-    // Extract the two numbers from the match
-    int num1StartIdx = match.find("(") + 1;
-    int num1EndIdx = match.find(",");
-    int num2EndIdx = match.find(")");
-    int num1 = std::stoi(match.substr(num1StartIdx, num1EndIdx - num1StartIdx));
-    int num2 = std::stoi(match.substr(num1EndIdx + 1, num2EndIdx - num1EndIdx - 1));
-    // Multiply the numbers and return the result
-    return num1 * num2;
+ * @param data The bytes to search.
+ * @param pos The offset to start searching from.
+ * @param size The number of bytes in data.
+ * @param includeDo Flag to also stop at 'd'.
+ * @return The offset of the next candidate byte, or size if there is none.
+ */
+size_t findCandidate(const char* data, size_t pos, size_t size, bool includeDo) {
+#if defined(__AVX2__)
+    const __m256i m = _mm256_set1_epi8('m');
+    const __m256i d = _mm256_set1_epi8(includeDo ? 'd' : 'm');
+    for (; pos + 32 <= size; pos += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, m), _mm256_cmpeq_epi8(chunk, d))));
+        if (mask != 0) {
+            return pos + __builtin_ctz(mask);
+        }
+    }
+#elif defined(__SSE2__)
+    const __m128i m = _mm_set1_epi8('m');
+    const __m128i d = _mm_set1_epi8(includeDo ? 'd' : 'm');
+    for (; pos + 16 <= size; pos += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, m), _mm_cmpeq_epi8(chunk, d))));
+        if (mask != 0) {
+            return pos + __builtin_ctz(mask);
+        }
+    }
+#endif
+    for (; pos < size; pos++) {
+        if (data[pos] == 'm' || (includeDo && data[pos] == 'd')) {
+            return pos;
+        }
+    }
+    return size;
 }
 
 /**
- * Helper to check if a match is a do() match
+ * Hand-written state machine that recognizes mul(<int>,<int>), with each int a 1-3 digit number,
+ * and optionally do() and don't(), in one forward pass. When a byte does not continue the current
+ * instruction the scanner drops back to Idle and retries that byte, which gives the same matches as
+ * the regex: no instruction contains an 'm' or 'd' after its first byte, so no match can start
+ * inside a partial one. While Idle, the scanner jumps straight to the next candidate byte.
  * 
- * @param match The string that contains the match.
- * @return true if the match is a do() match, false otherwise.
+ * @param state The scanner state, carried over from the previous call.
+ * @param data The bytes to scan.
+ * @param size The number of bytes to scan.
+ * @param includeDo Flag to include do() and don't() instructions.
+ * @param emit Called with each recognized instruction and the offset of its closing parenthesis.
  */
-bool isDoMatch(const std::string& match) {
-    return match.find("do(") != std::string::npos;
+template <typename Emit>
+void scanInstructions(ScanState& state, const char* data, size_t size, bool includeDo, Emit&& emit) {
+    for (size_t i = 0; i < size; i++) {
+        if (state.phase == ScanState::Idle) {
+            i = findCandidate(data, i, size, includeDo);
+            if (i == size) {
+                break;
+            }
+        }
+        char c = data[i];
+        bool advanced = true;
+        switch (state.phase) {
+            case ScanState::Idle:
+                advanced = false;
+                break;
+            case ScanState::M:
+                advanced = c == 'u';
+                state.phase = ScanState::MU;
+                break;
+            case ScanState::MU:
+                advanced = c == 'l';
+                state.phase = ScanState::MUL;
+                break;
+            case ScanState::MUL:
+                advanced = c == '(';
+                state.phase = ScanState::FirstOperand;
+                state.a = 0;
+                state.digits = 0;
+                break;
+            case ScanState::FirstOperand:
+                if (c >= '0' && c <= '9' && state.digits < 3) {
+                    state.a = state.a * 10 + (c - '0');
+                    state.digits++;
+                } else if (c == ',' && state.digits > 0) {
+                    state.phase = ScanState::SecondOperand;
+                    state.b = 0;
+                    state.digits = 0;
+                } else {
+                    advanced = false;
+                }
+                break;
+            case ScanState::SecondOperand:
+                if (c >= '0' && c <= '9' && state.digits < 3) {
+                    state.b = state.b * 10 + (c - '0');
+                    state.digits++;
+                } else if (c == ')' && state.digits > 0) {
+                    emit(Instruction{OpKind::Mul, state.a, state.b}, i);
+                    state.phase = ScanState::Idle;
+                } else {
+                    advanced = false;
+                }
+                break;
+            case ScanState::D:
+                advanced = c == 'o';
+                state.phase = ScanState::DO;
+                break;
+            case ScanState::DO:
+                if (c == '(') {
+                    state.phase = ScanState::DoOpen;
+                } else if (c == 'n') {
+                    state.phase = ScanState::DON;
+                } else {
+                    advanced = false;
+                }
+                break;
+            case ScanState::DoOpen:
+                advanced = c == ')';
+                if (advanced) {
+                    emit(Instruction{OpKind::Do, 0, 0}, i);
+                    state.phase = ScanState::Idle;
+                }
+                break;
+            case ScanState::DON:
+                advanced = c == '\'';
+                state.phase = ScanState::DONApos;
+                break;
+            case ScanState::DONApos:
+                advanced = c == 't';
+                state.phase = ScanState::DONT;
+                break;
+            case ScanState::DONT:
+                advanced = c == '(';
+                state.phase = ScanState::DontOpen;
+                break;
+            case ScanState::DontOpen:
+                advanced = c == ')';
+                if (advanced) {
+                    emit(Instruction{OpKind::Dont, 0, 0}, i);
+                    state.phase = ScanState::Idle;
+                }
+                break;
+        }
+        // Retry the byte as the start of a new instruction
+        if (!advanced) {
+            if (c == 'm') {
+                state.phase = ScanState::M;
+            } else if (c == 'd' && includeDo) {
+                state.phase = ScanState::D;
+            } else {
+                state.phase = ScanState::Idle;
+            }
+        }
+    }
 }
 
 /**
- * Helper to check if a match is a don't() match
- * 
- * @param match The string that contains the match.
- * @return true if the match is a don't() match, false otherwise.
+ * Instructions stored as a struct of arrays: one array each for the kinds and the two operands
+ */
+struct TokenBuffer {
+    std::vector<OpKind> kinds;
+    std::vector<uint16_t> a;
+    std::vector<uint16_t> b;
+
+    size_t size() const { return kinds.size(); }
+    Instruction instruction(size_t i) const { return Instruction{kinds[i], a[i], b[i]}; }
+    void push(const Instruction& instruction) {
+        kinds.push_back(instruction.kind);
+        a.push_back(static_cast<uint16_t>(instruction.a));
+        b.push_back(static_cast<uint16_t>(instruction.b));
+    }
+};
+
+/**
+ * Helper to find the instructions in the input
+ * We are looking for sequences in the string that match mul(<int>, <int>)
+ * Where each int as a 1-3 digit number
+ * We are also looking for do() and don't() matches
+ * @param input The input string to search.
+ * @param tokens A reference to the buffer to store the instructions.
  */
-bool isDontMatch(const std::string& match) {
-    return match.find("don't(") != std::string::npos;
+void findMatches(const std::string& input, TokenBuffer& tokens) {
+    ScanState state;
+    scanInstructions(state, input.data(), input.size(), true, [&tokens](const Instruction& instruction, size_t) {
+        tokens.push(instruction);
+    });
 }
 
 /** 
- * Helper to executes the list of matched multiplications and sum them up
+ * Helper to executes the list of matched multiplications and sum them up, both with and without
+ * the do() and don't() instructions, in a single pass over the tokens
  * 
- * @param matches The vector of matches to execute.
- * @param result A reference to the integer to store the result.
+ * @param tokens The instructions to execute.
+ * @param result A reference to the integer to store the sum of all multiplications.
+ * @param doResult A reference to the integer to store the sum of the enabled multiplications.
  */
-void executeMatches(const std::vector<std::string>& matches, int& result) {
+void executeMatches(const TokenBuffer& tokens, int64_t& result, int64_t& doResult) {
     // Iterate over the matches
     bool doFlag = true;
-    for (const std::string& match : matches) {
-        if (isDoMatch(match)) {
+    for (size_t i = 0; i < tokens.size(); i++) {
+        if (tokens.kinds[i] == OpKind::Do) {
             doFlag = true;
             continue;
-        } else if (isDontMatch(match)) {
+        } else if (tokens.kinds[i] == OpKind::Dont) {
             doFlag = false;
             continue;
         }
+        int64_t product = static_cast<int64_t>(tokens.a[i]) * tokens.b[i];
+        result += product;
         if (doFlag) {
-            result += executeMatch(match);
+            doResult += product;
+        }
+    }
+}
+
+/**
+ * Partial results for one chunk of the input. Since the chunk does not know whether the instructions
+ * before it left multiplications enabled, it keeps a sum for both cases.
+ */
+struct ChunkResult {
+    int64_t all = 0;
+    int64_t ifEnabled = 0;
+    int64_t ifDisabled = 0;
+    bool toggled = false;
+    bool endsEnabled = true;
+};
+
+/**
+ * Longest instruction the scanner recognizes: mul(123,456)
+ */
+const size_t maxInstructionLength = 12;
+
+/**
+ * Helper to evaluate the instructions that end inside one chunk of the input.
+ * Scanning starts far enough before the chunk to catch an instruction that crosses into it, and
+ * instructions that end before the chunk are left to the previous one.
+ * 
+ * @param input The input string.
+ * @param begin The first byte of the chunk.
+ * @param end One past the last byte of the chunk.
+ * @return The partial results for the chunk.
+ */
+ChunkResult evaluateChunk(const std::string& input, size_t begin, size_t end) {
+    ChunkResult chunk;
+    bool enabled = true;
+    bool disabled = false;
+    size_t from = begin > maxInstructionLength - 1 ? begin - (maxInstructionLength - 1) : 0;
+    ScanState state;
+    scanInstructions(state, input.data() + from, end - from, true, [&](const Instruction& instruction, size_t offset) {
+        if (from + offset < begin) {
+            return;
+        }
+        switch (instruction.kind) {
+            case OpKind::Mul: {
+                int64_t product = static_cast<int64_t>(instruction.a) * instruction.b;
+                chunk.all += product;
+                chunk.ifEnabled += enabled ? product : 0;
+                chunk.ifDisabled += disabled ? product : 0;
+                break;
+            }
+            case OpKind::Do:
+                enabled = disabled = true;
+                chunk.toggled = true;
+                chunk.endsEnabled = true;
+                break;
+            case OpKind::Dont:
+                enabled = disabled = false;
+                chunk.toggled = true;
+                chunk.endsEnabled = false;
+                break;
+        }
+    });
+    return chunk;
+}
+
+/**
+ * Evaluates the input on several threads. Each thread scans one chunk and sums its multiplications
+ * both for a chunk that starts enabled and for one that starts disabled. A sequential pass over the
+ * chunks then picks the right sum for each one, carrying the do() and don't() state from chunk to chunk.
+ * 
+ * @param input The input string.
+ * @param threads The number of threads to use.
+ * @param result A reference to the integer to store the sum of all multiplications.
+ * @param doResult A reference to the integer to store the sum of the enabled multiplications.
+ */
+void executeParallel(const std::string& input, unsigned threads, int64_t& result, int64_t& doResult) {
+    std::vector<std::future<ChunkResult>> futures;
+    for (unsigned t = 0; t < threads; t++) {
+        size_t begin = input.size() * t / threads;
+        size_t end = input.size() * (t + 1) / threads;
+        futures.push_back(std::async(std::launch::async, evaluateChunk, std::cref(input), begin, end));
+    }
+
+    bool enabled = true;
+    for (auto& future : futures) {
+        ChunkResult chunk = future.get();
+        result += chunk.all;
+        doResult += enabled ? chunk.ifEnabled : chunk.ifDisabled;
+        if (chunk.toggled) {
+            enabled = chunk.endsEnabled;
+        }
+    }
+}
+
+/**
+ * Evaluates the instructions read from a file descriptor, such as stdin or a pipe, in fixed-size buffers.
+ * The scanner state carries a partial instruction from one buffer to the next, and both sums are updated
+ * as each instruction is recognized, so memory use does not depend on the length of the input.
+ * 
+ * @param fd The file descriptor to read from.
+ * @param result A reference to the integer to store the sum of all multiplications.
+ * @param doResult A reference to the integer to store the sum of the enabled multiplications.
+ * @return true if the input was read successfully, false otherwise.
+ */
+bool executeStream(int fd, int64_t& result, int64_t& doResult) {
+    std::vector<char> buffer(1 << 16);
+    ScanState state;
+    bool doFlag = true;
+    while (true) {
+        ssize_t bytes = read(fd, buffer.data(), buffer.size());
+        if (bytes < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            std::cerr << "Unable to read input" << std::endl;
+            return false;
+        }
+        if (bytes == 0) {
+            break;
         }
+        scanInstructions(state, buffer.data(), static_cast<size_t>(bytes), true, [&](const Instruction& instruction, size_t) {
+            if (instruction.kind == OpKind::Do) {
+                doFlag = true;
+            } else if (instruction.kind == OpKind::Dont) {
+                doFlag = false;
+            } else {
+                int64_t product = static_cast<int64_t>(instruction.a) * instruction.b;
+                result += product;
+                if (doFlag) {
+                    doResult += product;
+                }
+            }
+        });
     }
+    return true;
 }
 
 /**
@@ -119,22 +446,58 @@ void executeMatches(const std::vector<std::string>& matches, int& result) {
  */
 int main(int argc, char* argv[]) {
     // Check if the file name was provided as an argument
-    if (argc != 2) {
-        std::cerr << "Usage: " << argv[0] << " <filename>" << std::endl;
+    bool streaming = argc == 3 && std::string(argv[2]) == "--stream";
+    if (argc != 2 && !streaming && !(argc == 4 && std::string(argv[2]) == "--parallel")) {
+        std::cerr << "Usage: " << argv[0] << " <filename> [--parallel <threads> | --stream]" << std::endl;
+        std::cerr << "Use - as the filename to read from stdin with --stream." << std::endl;
         return 1;
     }
     // Get the file name from the command-line argument
     std::string filename = argv[1];
+    // Stream the input through a fixed-size buffer
+    if (streaming) {
+        int fd = filename == "-" ? STDIN_FILENO : open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "Unable to open file " << filename << std::endl;
+            return 1;
+        }
+        int64_t result = 0;
+        int64_t doResult = 0;
+        bool valid = executeStream(fd, result, doResult);
+        if (fd != STDIN_FILENO) {
+            close(fd);
+        }
+        if (!valid) {
+            return 1;
+        }
+        std::cout << "Result: " << result << std::endl;
+        std::cout << "Result with do() and dont(): " << doResult << std::endl;
+        return 0;
+    }
     // String to store the input
     std::string input;
-    // list of strings to store the matches
-    std::vector<std::string> matches;
+    // Split the input across threads when asked to
+    if (argc == 4) {
+        unsigned threads = std::stoul(argv[3]);
+        if (threads == 0) {
+            threads = std::max(std::thread::hardware_concurrency(), 1u);
+        }
+        if (!readFileIntoString(filename, input)) {
+            return 1;
+        }
+        int64_t result = 0;
+        int64_t doResult = 0;
+        executeParallel(input, threads, result, doResult);
+        std::cout << "Result: " << result << std::endl;
+        std::cout << "Result with do() and dont(): " << doResult << std::endl;
+        return 0;
+    }
+    // buffer of the instructions found in the input
+    TokenBuffer tokens;
     // Result of the summed multiplications
-    int result = 0;
-    // matches include do() and dont() matches
-    std::vector<std::string> doMatches;
+    int64_t result = 0;
     // Result of the summed multiplications with do() and dont() matches
-    int doResult = 0;
+    int64_t doResult = 0;
     // Read the file into input
     if (readFileIntoString(filename, input)) {
         // Print the first few characters of the input
@@ -143,28 +506,20 @@ int main(int argc, char* argv[]) {
             std::cout << input[i];
         }
         std::cout << std::endl;
-        // Find the matches in the input
-        findMatches(input, matches);
+        // Find the matches in the input, including do() and dont()
+        findMatches(input, tokens);
         // Print the first few matches
         std::cout << "First few matches:" << std::endl;
-        for (int i = 0; i < 5 && i < matches.size(); i++) {
-            std::cout << matches[i] << std::endl;
+        for (size_t i = 0; i < 5 && i < tokens.size(); i++) {
+            std::cout << tokens.instruction(i) << std::endl;
         }
-        // Execute the matches and sum the multiplications
-        executeMatches(matches, result);
-        // Print the result
+        // Execute the matches and sum the multiplications, with and without do() and dont()
+        executeMatches(tokens, result, doResult);
+        // Print the results
         std::cout << "Result: " << result << std::endl;
-        // Find the matches in the input including do() and dont()
-        findMatches(input, doMatches, true);
-        // Print the first few matches with do() and dont()
-        std::cout << "First few matches with do() and dont():" << std::endl;
-        for (int i = 0; i < 5 && i < doMatches.size(); i++) {
-            std::cout << doMatches[i] << std::endl;
-        }
-        // Execute the matches with do() and dont() and sum the multiplications
-        executeMatches(doMatches, doResult);
-        // Print the result with do() and dont()
         std::cout << "Result with do() and dont(): " << doResult << std::endl;
+    } else {
+        return 1;
     }
     return 0;
 }
\ No newline at end of file
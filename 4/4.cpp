@@ -1,48 +1,96 @@
 #include <iostream>
 #include <fstream>
-#include <sstream>
 #include <vector>
 #include <string>
+#include <algorithm>
+#include <cstdint>
+#include <future>
+#include <thread>
 
 /**
+ * Encoding of the letters: {X -> 0, M -> 1, A -> 2, S -> 3}
+ */
+enum Letter { X = 0, M = 1, A = 2, S = 3 };
+
+/**
+ * The letter grid stored as one bitplane per letter. Bit c of a plane's row is set when that
+ * letter is in column c. Each row holds its four planes back to back, each plane `stride` 64-bit
+ * words wide, including one spare zero word at the end so that reading a row shifted to the left
+ * never runs past it.
+ */
+struct BitGrid {
+    size_t rows = 0;
+    size_t cols = 0;
+    size_t stride = 0;
+    std::vector<uint64_t> bits;
+
+    const uint64_t* row(size_t r) const { return bits.data() + r * 4 * stride; }
+    uint64_t* row(size_t r) { return bits.data() + r * 4 * stride; }
+};
+
+/**
+ * Helper to read 64 cells of one letter from a packed row, starting `shift` columns to the right of word w.
  * 
- * Reads the input file into a nested vector of integers.
- * Uses the following encoding rule: {X -> 0, M -> 1, A -> 2, S -> 3}
- * Each inner vector represents a line in the file.
+ * @param row The packed row.
+ * @param stride The number of words in each plane of the row.
+ * @param letter The letter to read.
+ * @param w The word to read.
+ * @param shift The number of columns to shift by, from 0 to 63.
+ * @return The bits of the 64 cells.
+ */
+inline uint64_t planeWord(const uint64_t* row, size_t stride, int letter, size_t w, int shift) {
+    const uint64_t* plane = row + letter * stride;
+    return shift == 0 ? plane[w] : (plane[w] >> shift) | (plane[w + 1] << (64 - shift));
+}
+
+/**
+ * Helper to pack one line of the input into the four bitplanes of a row.
+ * Characters other than X, M, A and S leave their cell empty in every plane.
+ * 
+ * @param line The line to pack.
+ * @param row The packed row to fill, which must be zeroed.
+ * @param stride The number of words in each plane of the row.
+ */
+void packRow(const std::string& line, uint64_t* row, size_t stride) {
+    for (size_t c = 0; c < line.size(); c++) {
+        int letter;
+        switch (line[c]) {
+            case 'X':
+                letter = X;
+                break;
+            case 'M':
+                letter = M;
+                break;
+            case 'A':
+                letter = A;
+                break;
+            case 'S':
+                letter = S;
+                break;
+            default:
+                continue;
+        }
+        row[letter * stride + c / 64] |= uint64_t(1) << (c % 64);
+    }
+}
+
+/**
+ * Reads the input file into a vector of lines.
  * 
  * @param filename The name of the file to read.
- * @param input A reference to the vector to store the input.
+ * @param lines A reference to the vector to store the lines.
  */
-bool readFileIntoVector(const std::string& filename, std::vector<std::vector<int>>& input) {
+bool readFileIntoLines(const std::string& filename, std::vector<std::string>& lines) {
     // Open the file
     std::ifstream file(filename);
     if (!file.is_open()) {
         std::cerr << "Unable to open file " << filename << std::endl;
         return false;
     }
-    // Read the file into a vector
+    // Read the file line by line
     std::string line;
     while (std::getline(file, line)) {
-        std::vector<int> row;
-        for (char c : line) {
-            switch (c) {
-                case 'X':
-                    row.push_back(0);
-                    break;
-                case 'M':
-                    row.push_back(1);
-                    break;
-                case 'A':
-                    row.push_back(2);
-                    break;
-                case 'S':
-                    row.push_back(3);
-                    break;
-                default:
-                    break;
-            }
-        }
-        input.push_back(row);
+        lines.push_back(line);
     }
     // Close the file
     file.close();
@@ -50,176 +98,492 @@ bool readFileIntoVector(const std::string& filename, std::vector<std::vector<int
 }
 
 /**
- * Helper to find horizontal matches in the input
- * A match is a row containing the sequence 0123 or 3210
  * 
- * @param input The input vector to search.
- * @return matches the number of matches found.
+ * Reads the input file into a bitplane grid.
+ * Uses the following encoding rule: {X -> 0, M -> 1, A -> 2, S -> 3}
+ * Each line of the file becomes one row of the grid.
+ * 
+ * @param filename The name of the file to read.
+ * @param grid A reference to the grid to store the input.
  */
-int findHorizontalMatches(const std::vector<std::vector<int>>& input) {
-    int matches = 0;
-    for (const std::vector<int>& row : input) {
-        for (int i = 0; i < row.size() - 3; i++) {
-            if ((row[i] == 0 && row[i + 1] == 1 && row[i + 2] == 2 && row[i + 3] == 3) ||
-                (row[i] == 3 && row[i + 1] == 2 && row[i + 2] == 1 && row[i + 3] == 0)) {
-                matches++;
-            }
-        }
+bool readFileIntoGrid(const std::string& filename, BitGrid& grid) {
+    // Read the lines, then pack them once the width is known
+    std::vector<std::string> lines;
+    if (!readFileIntoLines(filename, lines)) {
+        return false;
+    }
+    for (const std::string& line : lines) {
+        grid.cols = std::max(grid.cols, line.size());
+    }
+
+    grid.rows = lines.size();
+    grid.stride = (grid.cols + 63) / 64 + 1;
+    grid.bits.assign(grid.rows * 4 * grid.stride, 0);
+    for (size_t r = 0; r < grid.rows; r++) {
+        packRow(lines[r], grid.row(r), grid.stride);
     }
-    return matches;
+    return true;
 }
 
-/** 
- * Helper to find vertical matches in the input
- * A match is a column containing the sequence 0123 or 3210
+/**
+ * Number of matches found in each direction, plus the special X-MAS matches
+ */
+struct MatchCounts {
+    int64_t horizontal = 0;
+    int64_t vertical = 0;
+    int64_t diagonal = 0;
+    int64_t backwardsDiagonal = 0;
+    int64_t special = 0;
+
+    int64_t total() const { return horizontal + vertical + diagonal + backwardsDiagonal; }
+};
+
+/**
+ * Helper to count every kind of match whose top-left cell lies in word w of the first row.
+ * A match is the sequence 0123 or 3210 horizontally, vertically, diagonally or backwards diagonally,
+ * or the special X-MAS shape. Row k is shifted by k columns to line up a diagonal, and by 3 - k for a
+ * backwards diagonal, which is counted at its leftmost column. All of them share the same loaded rows.
  * 
- * @param input The input vector to search.
- * @return matches the number of matches found.
+ * @param rows The packed rows r to r + 3, with nullptr for rows past the bottom of the grid.
+ * @param stride The number of words in each plane of a row.
+ * @param w The word to count.
+ * @param counts A reference to the counts to add to.
  */
-int findVerticalMatches(const std::vector<std::vector<int>>& input) {
-    int matches = 0;
-    for (int i = 0; i < input[0].size(); i++) {
-        for (int j = 0; j < input.size() - 3; j++) {
-            if ((input[j][i] == 0 && input[j + 1][i] == 1 && input[j + 2][i] == 2 && input[j + 3][i] == 3) ||
-                (input[j][i] == 3 && input[j + 1][i] == 2 && input[j + 2][i] == 1 && input[j + 3][i] == 0)) {
-                matches++;
-            }
-        }
+inline void countWord(const uint64_t* const rows[4], size_t stride, size_t w, MatchCounts& counts) {
+    const uint64_t* top = rows[0];
+    uint64_t forward = planeWord(top, stride, X, w, 0) & planeWord(top, stride, M, w, 1) &
+                       planeWord(top, stride, A, w, 2) & planeWord(top, stride, S, w, 3);
+    uint64_t backward = planeWord(top, stride, S, w, 0) & planeWord(top, stride, A, w, 1) &
+                        planeWord(top, stride, M, w, 2) & planeWord(top, stride, X, w, 3);
+    counts.horizontal += __builtin_popcountll(forward | backward);
+
+    if (rows[2] == nullptr) {
+        return;
+    }
+    const uint64_t* middle = rows[1];
+    const uint64_t* bottom = rows[2];
+    uint64_t center = planeWord(middle, stride, A, w, 1);
+    uint64_t diagonal = (planeWord(top, stride, M, w, 0) & planeWord(bottom, stride, S, w, 2)) |
+                        (planeWord(top, stride, S, w, 0) & planeWord(bottom, stride, M, w, 2));
+    uint64_t backwardsDiagonal = (planeWord(bottom, stride, M, w, 0) & planeWord(top, stride, S, w, 2)) |
+                                 (planeWord(bottom, stride, S, w, 0) & planeWord(top, stride, M, w, 2));
+    counts.special += __builtin_popcountll(center & diagonal & backwardsDiagonal);
+
+    if (rows[3] == nullptr) {
+        return;
+    }
+    forward = backward = ~uint64_t(0);
+    uint64_t diagonalForward = ~uint64_t(0);
+    uint64_t diagonalBackward = ~uint64_t(0);
+    uint64_t backwardsForward = ~uint64_t(0);
+    uint64_t backwardsBackward = ~uint64_t(0);
+    for (int k = 0; k < 4; k++) {
+        forward &= planeWord(rows[k], stride, k, w, 0);
+        backward &= planeWord(rows[k], stride, 3 - k, w, 0);
+        diagonalForward &= planeWord(rows[k], stride, k, w, k);
+        diagonalBackward &= planeWord(rows[k], stride, 3 - k, w, k);
+        backwardsForward &= planeWord(rows[k], stride, k, w, 3 - k);
+        backwardsBackward &= planeWord(rows[k], stride, 3 - k, w, 3 - k);
     }
-    return matches;
+    counts.vertical += __builtin_popcountll(forward | backward);
+    counts.diagonal += __builtin_popcountll(diagonalForward | diagonalBackward);
+    counts.backwardsDiagonal += __builtin_popcountll(backwardsForward | backwardsBackward);
 }
 
 /**
- * Helper to find diagonal matches in the input
- * A match is a diagonal containing the sequence 0123 or 3210
+ * Helper to count the matches whose top row lies in [beginRow, endRow), reading up to three rows past endRow.
+ * The grid is walked in strips of columns, top to bottom, so the four rows in use for a strip stay in cache.
  * 
- * @param input The input vector to search.
- * @return matches the number of matches found.
+ * @param grid The grid to search.
+ * @param beginRow The first row to count.
+ * @param endRow One past the last row to count.
+ * @param counts A reference to the counts to add to.
  */
-int findDiagonalMatches(const std::vector<std::vector<int>>& input) {
-    int matches = 0;
-    for (int i = 0; i < input.size() - 3; i++) {
-        for (int j = 0; j < input[0].size() - 3; j++) {
-            if ((input[i][j] == 0 && input[i + 1][j + 1] == 1 && input[i + 2][j + 2] == 2 && input[i + 3][j + 3] == 3) ||
-                (input[i][j] == 3 && input[i + 1][j + 1] == 2 && input[i + 2][j + 2] == 1 && input[i + 3][j + 3] == 0)) {
-                matches++;
+void countMatchesInRows(const BitGrid& grid, size_t beginRow, size_t endRow, MatchCounts& counts) {
+    const size_t tileWords = 64;
+    size_t words = grid.stride - 1;
+    for (size_t w0 = 0; w0 < words; w0 += tileWords) {
+        size_t w1 = std::min(w0 + tileWords, words);
+        for (size_t r = beginRow; r < endRow; r++) {
+            const uint64_t* rows[4];
+            for (size_t k = 0; k < 4; k++) {
+                rows[k] = r + k < grid.rows ? grid.row(r + k) : nullptr;
+            }
+            for (size_t w = w0; w < w1; w++) {
+                countWord(rows, grid.stride, w, counts);
             }
         }
     }
-    return matches;
 }
 
 /**
- * Helper to find backwards diagonal matches in the input
- * A match is a backwards diagonal containing the sequence 0123 or 3210
+ * Helper to count the matches on several threads. The grid is split into one horizontal band of rows per
+ * thread, and each thread counts the matches whose top row lies in its band, reading the three rows below
+ * the band as a halo, so a match that crosses a band edge is counted exactly once.
  * 
- * @param input The input vector to search.
- * @return matches the number of matches found.
+ * @param grid The grid to search.
+ * @param threads The number of threads to use.
+ * @param counts A reference to the counts to add to.
  */
-int findBackwardsDiagonalMatches(const std::vector<std::vector<int>>& input) {
-    int matches = 0;
-    for (int i = 0; i < input.size() - 3; i++) {
-        for (int j = 3; j < input[0].size(); j++) {
-            if ((input[i][j] == 0 && input[i + 1][j - 1] == 1 && input[i + 2][j - 2] == 2 && input[i + 3][j - 3] == 3) ||
-                (input[i][j] == 3 && input[i + 1][j - 1] == 2 && input[i + 2][j - 2] == 1 && input[i + 3][j - 3] == 0)) {
-                matches++;
+void countMatchesParallel(const BitGrid& grid, unsigned threads, MatchCounts& counts) {
+    std::vector<std::future<MatchCounts>> futures;
+    for (unsigned t = 0; t < threads; t++) {
+        size_t beginRow = grid.rows * t / threads;
+        size_t endRow = grid.rows * (t + 1) / threads;
+        futures.push_back(std::async(std::launch::async, [&grid, beginRow, endRow]() {
+            MatchCounts band;
+            countMatchesInRows(grid, beginRow, endRow, band);
+            return band;
+        }));
+    }
+    for (auto& future : futures) {
+        MatchCounts band = future.get();
+        counts.horizontal += band.horizontal;
+        counts.vertical += band.vertical;
+        counts.diagonal += band.diagonal;
+        counts.backwardsDiagonal += band.backwardsDiagonal;
+        counts.special += band.special;
+    }
+}
+
+/**
+ * Helper to count the matches in a file without loading the grid, for grids larger than memory.
+ * Only the last four packed rows are kept, in a ring buffer. Once a row has its three successors,
+ * every match whose top row it is gets counted; the last three rows are counted at the end of the file.
+ * The planes widen as longer lines arrive, so the width does not need to be known up front.
+ * 
+ * @param filename The name of the file to read.
+ * @param counts A reference to the counts to add to.
+ */
+bool countMatchesStreaming(const std::string& filename, MatchCounts& counts) {
+    // Open the file
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Unable to open file " << filename << std::endl;
+        return false;
+    }
+
+    // Ring buffer of the last four rows, row r in slot r % 4
+    size_t stride = 1;
+    std::vector<uint64_t> ring(4 * 4 * stride, 0);
+    auto slot = [&ring, &stride](size_t r) { return ring.data() + (r % 4) * 4 * stride; };
+
+    // Counts every match whose top row is `top`, given that rows up to `last` have been read
+    auto countTop = [&](size_t top, size_t last) {
+        const uint64_t* rows[4];
+        for (size_t k = 0; k < 4; k++) {
+            rows[k] = top + k <= last ? slot(top + k) : nullptr;
+        }
+        for (size_t w = 0; w + 1 < stride; w++) {
+            countWord(rows, stride, w, counts);
+        }
+    };
+
+    std::string line;
+    size_t r = 0;
+    for (; std::getline(file, line); r++) {
+        // Widen every row in the ring if this line does not fit
+        size_t needed = (line.size() + 63) / 64 + 1;
+        if (needed > stride) {
+            std::vector<uint64_t> wider(4 * 4 * needed, 0);
+            for (size_t plane = 0; plane < 4 * 4; plane++) {
+                std::copy(ring.begin() + plane * stride, ring.begin() + (plane + 1) * stride,
+                          wider.begin() + plane * needed);
             }
+            ring.swap(wider);
+            stride = needed;
         }
+        std::fill(slot(r), slot(r) + 4 * stride, 0);
+        packRow(line, slot(r), stride);
+        if (r >= 3) {
+            countTop(r - 3, r);
+        }
+    }
+    // Count the last rows, which have fewer than three rows below them
+    for (size_t top = r < 3 ? 0 : r - 3; top < r; top++) {
+        countTop(top, r - 1);
     }
-    return matches;
+    file.close();
+    return true;
 }
 
 /**
- * Find all matches in the input
+ * Print the number of matches found in each direction.
  * 
- * @param input The input vector to search.
- * @param matches The number of matches found.
- *
+ * @param counts The number of matches found of each kind.
  */
-void findAllMatches(const std::vector<std::vector<int>>& input, int& matches) {
-    int horizontalMatches = findHorizontalMatches(input);
-    std::cout << "Horizontal Matches: " << horizontalMatches << std::endl;
-    int verticalMatches = findVerticalMatches(input);
-    std::cout << "Vertical Matches: " << verticalMatches << std::endl;
-    int diagonalMatches = findDiagonalMatches(input);
-    std::cout << "Diagonal Matches: " << diagonalMatches << std::endl;
-    int backwardsDiagonalMatches = findBackwardsDiagonalMatches(input);
-    std::cout << "Backwards Diagonal Matches: " << backwardsDiagonalMatches << std::endl;
-    matches = horizontalMatches + verticalMatches + diagonalMatches + backwardsDiagonalMatches;
+void printMatchCounts(const MatchCounts& counts) {
+    std::cout << "Horizontal Matches: " << counts.horizontal << std::endl;
+    std::cout << "Vertical Matches: " << counts.vertical << std::endl;
+    std::cout << "Diagonal Matches: " << counts.diagonal << std::endl;
+    std::cout << "Backwards Diagonal Matches: " << counts.backwardsDiagonal << std::endl;
 }
 
 /**
- * Check for 1,2,3 or 3,1,1 arranged diagonally, and verify that the number in the position 
- * 2 vertical positions below the top left is either 1 or 3, and the the number in the position
- * 2 horizontal positions to the right of the top left is the other in the pair.
+ * Find all matches in the input, in every direction and the special X-MAS shape, in one pass over the grid
  * 
- * @param input The input vector to search.
- * @param smatches The number of matches found.
+ * @param grid The grid to search.
+ * @param counts The number of matches found of each kind.
+ * @param threads The number of threads to use.
+ *
  */
-void findSpecialMatches(const std::vector<std::vector<int>>& input, int& matches) {
-    int specialMatches = 0;
-    for (int i = 0; i < input.size() - 2; i++) {
-        for (int j = 0; j < input[0].size() - 2; j++) {
-            if ((input[i][j] == 1 && input[i + 1][j + 1] == 2 && input[i + 2][j + 2] == 3) ||
-                (input[i][j] == 3 && input[i + 1][j + 1] == 2 && input[i + 2][j + 2] == 1)) {
-                if ((input[i + 2][j] == 1 && input[i][j + 2] == 3) ||
-                    (input[i + 2][j] == 3 && input[i][j + 2] == 1)) {
-                    specialMatches++;
+void findAllMatches(const BitGrid& grid, MatchCounts& counts, unsigned threads = 1) {
+    if (threads > 1) {
+        countMatchesParallel(grid, threads, counts);
+    } else {
+        countMatchesInRows(grid, 0, grid.rows, counts);
+    }
+    printMatchCounts(counts);
+}
+
+/**
+ * Aho-Corasick automaton for searching a grid for a dictionary of words in all 8 directions.
+ * Each word is added together with its reverse, so streaming every row, column, diagonal and
+ * backwards diagonal through the automaton once, in one direction, finds the words read both ways.
+ * The automaton is stored as a dense transition table over the characters that appear in the words;
+ * any other character sends it back to the root.
+ */
+class WordSearch {
+public:
+    /**
+     * Builds the automaton.
+     * 
+     * @param words The dictionary of words to search for. Empty words are never matched.
+     */
+    explicit WordSearch(const std::vector<std::string>& words) : numWords_(words.size()) {
+        // Number the characters that appear in the words, leaving 0 for every other character
+        std::fill(std::begin(symbolOf_), std::end(symbolOf_), 0);
+        numSymbols_ = 1;
+        for (const std::string& word : words) {
+            for (char c : word) {
+                uint8_t byte = static_cast<uint8_t>(c);
+                if (symbolOf_[byte] == 0) {
+                    symbolOf_[byte] = numSymbols_++;
+                }
+            }
+        }
+
+        // Build the trie of the words and their reverses
+        addNode();
+        for (const std::string& word : words) {
+            terminals_.push_back(insert(word.begin(), word.end()));
+            terminals_.push_back(insert(word.rbegin(), word.rend()));
+        }
+
+        // Fill in the failure links and the missing transitions breadth first
+        fail_.assign(numNodes(), 0);
+        order_.clear();
+        order_.push_back(0);
+        for (size_t i = 0; i < order_.size(); i++) {
+            int32_t node = order_[i];
+            for (size_t symbol = 0; symbol < numSymbols_; symbol++) {
+                int32_t& child = next_[node * numSymbols_ + symbol];
+                int32_t fallback = node == 0 ? 0 : next_[fail_[node] * numSymbols_ + symbol];
+                if (child < 0 || symbol == 0) {
+                    child = fallback;
+                } else {
+                    fail_[child] = fallback;
+                    order_.push_back(child);
                 }
             }
         }
     }
-    matches = specialMatches;
-}
 
+    /**
+     * Counts how many times each word appears in the grid, reading in any of the 8 directions.
+     * A word that reads the same both ways is counted once for each direction.
+     * 
+     * @param grid The lines of the grid. Lines may have different lengths.
+     * @param hits A reference to store the number of hits for each word, in dictionary order.
+     */
+    void searchGrid(const std::vector<std::string>& grid, std::vector<int64_t>& hits) const {
+        std::vector<int64_t> nodeHits(numNodes(), 0);
+        size_t rows = grid.size();
+        size_t cols = 0;
+        for (const std::string& line : grid) {
+            cols = std::max(cols, line.size());
+        }
+        auto at = [&grid](size_t r, size_t c) -> char {
+            return c < grid[r].size() ? grid[r][c] : '\0';
+        };
 
+        // Rows
+        for (size_t r = 0; r < rows; r++) {
+            int32_t state = 0;
+            for (size_t c = 0; c < grid[r].size(); c++) {
+                state = step(state, grid[r][c], nodeHits);
+            }
+        }
+        // Columns
+        for (size_t c = 0; c < cols; c++) {
+            int32_t state = 0;
+            for (size_t r = 0; r < rows; r++) {
+                state = step(state, at(r, c), nodeHits);
+            }
+        }
+        // Diagonals, going down and to the right, starting from the left column and the top row
+        for (size_t start = 0; start + 1 < rows + cols; start++) {
+            size_t r = start < rows ? rows - 1 - start : 0;
+            size_t c = start < rows ? 0 : start - rows + 1;
+            int32_t state = 0;
+            for (; r < rows && c < cols; r++, c++) {
+                state = step(state, at(r, c), nodeHits);
+            }
+        }
+        // Backwards diagonals, going down and to the left, starting from the top row and the right column
+        for (size_t start = 0; start + 1 < rows + cols; start++) {
+            size_t r = start < cols ? 0 : start - cols + 1;
+            size_t c = start < cols ? start : cols - 1;
+            int32_t state = 0;
+            for (; r < rows; r++, c--) {
+                state = step(state, at(r, c), nodeHits);
+                if (c == 0) {
+                    break;
+                }
+            }
+        }
+
+        // A hit on a node is also a hit on every node along its failure links
+        for (size_t i = order_.size(); i-- > 1;) {
+            nodeHits[fail_[order_[i]]] += nodeHits[order_[i]];
+        }
+        hits.assign(numWords_, 0);
+        for (size_t word = 0; word < numWords_; word++) {
+            int32_t forward = terminals_[2 * word];
+            int32_t backward = terminals_[2 * word + 1];
+            if (forward != 0) {
+                hits[word] = nodeHits[forward] + nodeHits[backward];
+            }
+        }
+    }
+
+private:
+    size_t numNodes() const { return next_.size() / numSymbols_; }
+
+    int32_t addNode() {
+        next_.resize(next_.size() + numSymbols_, -1);
+        return static_cast<int32_t>(numNodes() - 1);
+    }
+
+    template <typename Iterator>
+    int32_t insert(Iterator begin, Iterator end) {
+        int32_t node = 0;
+        for (Iterator it = begin; it != end; ++it) {
+            size_t index = node * numSymbols_ + symbolOf_[static_cast<uint8_t>(*it)];
+            if (next_[index] < 0) {
+                int32_t child = addNode();
+                next_[index] = child;
+            }
+            node = next_[index];
+        }
+        return node;
+    }
+
+    int32_t step(int32_t state, char c, std::vector<int64_t>& nodeHits) const {
+        state = next_[state * numSymbols_ + symbolOf_[static_cast<uint8_t>(c)]];
+        nodeHits[state]++;
+        return state;
+    }
+
+    size_t numWords_;
+    size_t numSymbols_ = 1;
+    uint32_t symbolOf_[256];
+    std::vector<int32_t> next_;
+    std::vector<int32_t> fail_;
+    std::vector<int32_t> order_;
+    std::vector<int32_t> terminals_;
+};
 
 /**
- * Main block. Receives a filename as an argument and reads the file into a nested vector.
+ * Main block. Receives a filename as an argument and reads the file into a bitplane grid.
  * 
  */
 int main(int argc, char* argv[]) {
     // Check if the file name was provided as an argument
-    if (argc != 2) {
-        std::cerr << "Usage: " << argv[0] << " <filename>" << std::endl;
+    std::string mode = argc >= 3 ? argv[2] : "";
+    if (!(argc == 2 || (argc == 3 && mode == "--stream") || (argc == 4 && (mode == "--parallel" || mode == "--words")))) {
+        std::cerr << "Usage: " << argv[0] << " <filename> [--parallel <threads> | --words <dictionary> | --stream]"
+                  << std::endl;
         return 1;
     }
 
     // Get the file name from the command-line argument
     std::string filename = argv[1];
 
-    // Vector to store the input
-    std::vector<std::vector<int>> input;
+    // Search for every word in a dictionary instead
+    if (mode == "--words") {
+        std::vector<std::string> grid;
+        std::vector<std::string> words;
+        if (!readFileIntoLines(filename, grid) || !readFileIntoLines(argv[3], words)) {
+            return 1;
+        }
+        WordSearch search(words);
+        std::vector<int64_t> hits;
+        search.searchGrid(grid, hits);
+        for (size_t i = 0; i < words.size(); i++) {
+            std::cout << words[i] << ": " << hits[i] << std::endl;
+        }
+        return 0;
+    }
 
-    // Int to store the number of matches
-    int matches;
+    // Count the matches while reading, keeping only the last four rows in memory
+    if (mode == "--stream") {
+        MatchCounts counts;
+        if (!countMatchesStreaming(filename, counts)) {
+            return 1;
+        }
+        printMatchCounts(counts);
+        std::cout << "Matches: " << counts.total() << std::endl;
+        std::cout << "Special Matches: " << counts.special << std::endl;
+        return 0;
+    }
+
+    // Number of threads to search with
+    unsigned threads = 1;
+    if (mode == "--parallel") {
+        threads = std::stoul(argv[3]);
+        if (threads == 0) {
+            threads = std::max(std::thread::hardware_concurrency(), 1u);
+        }
+    }
 
-    // Int to store the number of special matches
-    int specialMatches;
+    // Grid to store the input
+    BitGrid grid;
+
+    // Counts of the matches of each kind
+    MatchCounts counts;
 
     // Read the file into input
-    if (!readFileIntoVector(filename, input)) {
+    if (!readFileIntoGrid(filename, grid)) {
         return 1;
     }
 
     // Output the input if the filename has 'test' in it
     if (filename.find("test") != std::string::npos) {
         std::cout << "Input:" << std::endl;
-        for (const std::vector<int>& row : input) {
-            for (int val : row) {
-                std::cout << val << " ";
+        for (size_t r = 0; r < grid.rows; r++) {
+            for (size_t c = 0; c < grid.cols; c++) {
+                int val = -1;
+                for (int letter = X; letter <= S; letter++) {
+                    if ((grid.row(r)[letter * grid.stride + c / 64] >> (c % 64)) & 1) {
+                        val = letter;
+                    }
+                }
+                if (val < 0) {
+                    std::cout << ". ";
+                } else {
+                    std::cout << val << " ";
+                }
             }
             std::cout << std::endl;
         }
     }
     // Find all matches in the input
-    findAllMatches(input, matches);
+    findAllMatches(grid, counts, threads);
     // Output the number of matches
-    std::cout << "Matches: " << matches << std::endl;
-    // Find special matches in the input
-    findSpecialMatches(input, specialMatches);
+    std::cout << "Matches: " << counts.total() << std::endl;
     // Output the number of special matches
-    std::cout << "Special Matches: " << specialMatches << std::endl;
+    std::cout << "Special Matches: " << counts.special << std::endl;
     
     return 0;
 }
\ No newline at end of file
@@ -5,6 +5,10 @@
 #include <string>
 #include <map>
 #include <algorithm>
+#include <cstdint>
+#include <atomic>
+#include <future>
+#include <thread>
 
 /**
  * Reads the input file in the following format:
@@ -57,81 +61,294 @@ bool readFileIntoMap(const std::string& filename, std::vector<std::vector<int>>&
     return true;
 }
 
+/**
+ * The ordering rules compiled into a bit matrix, with bit b of row a set when a must come before b.
+ * Pages outside the matrix have no rules.
+ */
+struct RuleMatrix {
+    size_t size = 0;
+    size_t words = 0;
+    std::vector<uint64_t> bits;
+
+    const uint64_t* successors(int page) const { return bits.data() + page * words; }
+    bool contains(int page) const { return page >= 0 && static_cast<size_t>(page) < size; }
+    bool mustPrecede(int a, int b) const {
+        return contains(a) && contains(b) && ((successors(a)[b / 64] >> (b % 64)) & 1);
+    }
+};
+
+/**
+ * Compiles the ordering rules into a bit matrix sized to the largest page in the rules.
+ * 
+ * @param orderRules The list of pairs of pages, the first of which must come before the second.
+ * @param matrix A reference to the matrix to build.
+ */
+void buildRuleMatrix(const std::vector<std::vector<int>>& orderRules, RuleMatrix& matrix) {
+    int largest = -1;
+    for (const std::vector<int>& rule : orderRules) {
+        largest = std::max({largest, rule[0], rule[1]});
+    }
+    matrix.size = largest + 1;
+    matrix.words = (matrix.size + 63) / 64;
+    matrix.bits.assign(matrix.size * matrix.words, 0);
+    for (const std::vector<int>& rule : orderRules) {
+        if (rule[0] >= 0 && rule[1] >= 0) {
+            matrix.bits[rule[0] * matrix.words + rule[1] / 64] |= uint64_t(1) << (rule[1] % 64);
+        }
+    }
+}
+
 /** 
- * Helper to determine if a single input row follows the ordering rules
+ * Helper to determine if a single input row follows the ordering rules.
+ * Keeps a bitset of the pages seen so far; a page breaks the rules when it must come before one of them.
  * 
  * @param row The row to check.
- * @param orderRules The map containing the order of the pairs.
+ * @param rules The ordering rules.
+ * @param seen Scratch space for the bitset, reused across calls to avoid an allocation per row.
  */
-bool followsOrder(const std::vector<int>& row, const std::vector<std::vector<int>>& orderRules) {
-    // iterate through the rules
-    for (const std::vector<int>& rule : orderRules) {
-        // check if both ints in the pair are in the row
-        if (!(std::find(row.begin(), row.end(), rule[0]) == row.end() || std::find(row.begin(), row.end(), rule[1]) == row.end())) {
-            // check that rule[0] is to the left of rule[1]
-            if (std::find(row.begin(), row.end(), rule[0]) > std::find(row.begin(), row.end(), rule[1])) {
+bool followsOrder(const std::vector<int>& row, const RuleMatrix& rules, std::vector<uint64_t>& seen) {
+    // Most misordered rows break a rule between neighbours, which is cheaper to check first
+    for (size_t i = 1; i < row.size(); i++) {
+        if (rules.mustPrecede(row[i], row[i - 1])) {
+            return false;
+        }
+    }
+    seen.assign(rules.words, 0);
+    for (int page : row) {
+        if (!rules.contains(page)) {
+            continue;
+        }
+        const uint64_t* successors = rules.successors(page);
+        for (size_t w = 0; w < rules.words; w++) {
+            if (successors[w] & seen[w]) {
                 return false;
             }
         }
+        seen[page / 64] |= uint64_t(1) << (page % 64);
     }
-
-return true;
+    return true;
 }
+
 /**
- * Helper to correct the misordered rows
+ * Helper to put a row in an order that follows the rules by repeatedly taking the leftmost page
+ * that no remaining page has to come before. If the rules in the row form a cycle, the leftmost
+ * remaining page is taken instead so that every page is still placed.
  * 
- * @param row The row to check.
- * @param orderRules The map containing the order of the pairs.
+ * @param row The row to reorder.
+ * @param rules The ordering rules.
  */
-void correctOrder(std::vector<int>& row, const std::vector<std::vector<int>>& orderRules) {
-    while (!followsOrder(row, orderRules)){
-        // iterate through the rules
-        for (const std::vector<int>& rule : orderRules) {
-            // check if both ints in the pair are in the row
-            if (!(std::find(row.begin(), row.end(), rule[0]) == row.end() || std::find(row.begin(), row.end(), rule[1]) == row.end())) {
-                // check that rule[0] is to the left of rule[1]
-                if (std::find(row.begin(), row.end(), rule[0]) > std::find(row.begin(), row.end(), rule[1])) {
-                    std::iter_swap(std::find(row.begin(), row.end(), rule[0]), std::find(row.begin(), row.end(), rule[1]));
+void topologicalOrder(std::vector<int>& row, const RuleMatrix& rules) {
+    // Count how many pages in the row have to come before each page
+    std::vector<int> predecessors(row.size(), 0);
+    for (size_t i = 0; i < row.size(); i++) {
+        for (size_t j = 0; j < row.size(); j++) {
+            predecessors[i] += rules.mustPrecede(row[j], row[i]);
+        }
+    }
+    std::vector<bool> placed(row.size(), false);
+    std::vector<int> ordered;
+    ordered.reserve(row.size());
+    while (ordered.size() < row.size()) {
+        size_t next = row.size();
+        for (size_t i = 0; i < row.size(); i++) {
+            if (!placed[i] && (predecessors[i] == 0 || next == row.size())) {
+                next = i;
+                if (predecessors[i] == 0) {
+                    break;
                 }
             }
         }
+        placed[next] = true;
+        ordered.push_back(row[next]);
+        for (size_t i = 0; i < row.size(); i++) {
+            predecessors[i] -= rules.mustPrecede(row[next], row[i]);
+        }
     }
+    row.swap(ordered);
 }
 
 /**
- * Check each row in the input to see if it follows the ordering rules. 
- * Sum the middle values of the rows that follow the rules.
+ * Helper to correct the misordered rows by sorting them with the rules as the comparator.
+ * When the rules cover every pair in the row this is a single O(k log k) sort; otherwise the sort
+ * may leave a rule broken, and the row is ordered topologically instead.
+ * 
+ * @param row The row to check.
+ * @param rules The ordering rules.
+ * @param seen Scratch space for followsOrder.
+ */
+void correctOrder(std::vector<int>& row, const RuleMatrix& rules, std::vector<uint64_t>& seen) {
+    std::stable_sort(row.begin(), row.end(), [&rules](int a, int b) { return rules.mustPrecede(a, b); });
+    if (!followsOrder(row, rules, seen)) {
+        topologicalOrder(row, rules);
+    }
+}
+
+/**
+ * Helper to find the page that would be in the middle of the corrected row, without correcting it.
+ * Counts, for each page, how many other pages in the row it must come before. When the rules order
+ * every pair in the row those counts are exactly 0 to k - 1, and the page with k - 1 - k / 2 of them
+ * would land at index k / 2.
+ * 
+ * @param row The row to check.
+ * @param rules The ordering rules.
+ * @param middle A reference to store the middle page.
+ * @param mask Scratch space for the bitset of the pages in the row, reused across calls.
+ * @param counted Scratch space for the counts already taken, reused across calls.
+ * @return Whether the rules order every pair in the row, so that the middle page was found.
+ */
+bool findMiddlePage(const std::vector<int>& row, const RuleMatrix& rules, int& middle,
+    std::vector<uint64_t>& mask, std::vector<bool>& counted) {
+    // Bitset of the pages in the row
+    mask.assign(rules.words, 0);
+    for (int page : row) {
+        if (!rules.contains(page)) {
+            return false;
+        }
+        mask[page / 64] |= uint64_t(1) << (page % 64);
+    }
+
+    size_t target = row.size() - 1 - row.size() / 2;
+    counted.assign(row.size(), false);
+    bool found = false;
+    for (int page : row) {
+        const uint64_t* successors = rules.successors(page);
+        size_t count = 0;
+        for (size_t w = 0; w < rules.words; w++) {
+            count += __builtin_popcountll(successors[w] & mask[w]);
+        }
+        if (count >= row.size() || counted[count]) {
+            return false;
+        }
+        counted[count] = true;
+        if (count == target) {
+            middle = page;
+            found = true;
+        }
+    }
+    return found;
+}
+
+/**
+ * Helper to sum the middle values of the rows in [begin, end). Misordered rows are corrected in a
+ * scratch copy, so the input is left as it was read.
  * 
  * @param input The input vector to check.
- * @param orderRules The map containing the order of the pairs.
- * @param total The sum of the middle values of the rows that follow the rules.
+ * @param rules The ordering rules.
+ * @param begin The first row to check.
+ * @param end One past the last row to check.
+ * @param total A reference to add the middle values of the rows that follow the rules to.
+ * @param correctedTotal A reference to add the middle values of the corrected rows to.
+ * @param selectMiddle Whether to find the middle page of a misordered row without correcting it.
  */
-void sumMiddleValues(std::vector<std::vector<int>>& input, 
-    const std::vector<std::vector<int>>& orderRules,
-    int& total,
-    int& correctedTotal) {
-    // iterate through the input
-    for (std::vector<int>& row : input) {
+void sumMiddleValuesInRange(const std::vector<std::vector<int>>& input,
+    const RuleMatrix& rules,
+    size_t begin,
+    size_t end,
+    int64_t& total,
+    int64_t& correctedTotal,
+    bool selectMiddle) {
+    // Scratch space kept for the whole range
+    std::vector<int> corrected;
+    std::vector<uint64_t> seen;
+    std::vector<uint64_t> mask;
+    std::vector<bool> counted;
+    for (size_t i = begin; i < end; i++) {
+        const std::vector<int>& row = input[i];
+        int middle;
         // check if the row follows the order
-        if (followsOrder(row, orderRules)) {
+        if (followsOrder(row, rules, seen)) {
             total += row[row.size() / 2];
+        } else if (selectMiddle && findMiddlePage(row, rules, middle, mask, counted)) {
+            correctedTotal += middle;
         } else {
-            correctOrder(row, orderRules);
-            correctedTotal += row[row.size() / 2];
+            corrected.assign(row.begin(), row.end());
+            correctOrder(corrected, rules, seen);
+            correctedTotal += corrected[corrected.size() / 2];
         }
     }
 }
 
+/**
+ * Check each row in the input to see if it follows the ordering rules. 
+ * Sum the middle values of the rows that follow the rules, and of the misordered rows once corrected.
+ * With several threads, workers take chunks of rows one at a time and keep their own totals,
+ * which are added up at the end.
+ * 
+ * @param input The input vector to check.
+ * @param rules The ordering rules.
+ * @param total The sum of the middle values of the rows that follow the rules.
+ * @param correctedTotal The sum of the middle values of the misordered rows, once corrected.
+ * @param selectMiddle Whether to find the middle page of a misordered row without correcting it.
+ * @param threads The number of threads to use.
+ */
+void sumMiddleValues(const std::vector<std::vector<int>>& input, 
+    const RuleMatrix& rules,
+    int64_t& total,
+    int64_t& correctedTotal,
+    bool selectMiddle = false,
+    unsigned threads = 1) {
+    if (threads <= 1) {
+        sumMiddleValuesInRange(input, rules, 0, input.size(), total, correctedTotal, selectMiddle);
+        return;
+    }
+
+    const size_t chunkSize = 1024;
+    size_t numChunks = (input.size() + chunkSize - 1) / chunkSize;
+    std::atomic<size_t> nextChunk(0);
+
+    std::vector<std::future<std::pair<int64_t, int64_t>>> futures;
+    for (unsigned t = 0; t < threads; t++) {
+        futures.push_back(std::async(std::launch::async, [&]() -> std::pair<int64_t, int64_t> {
+            int64_t localTotal = 0;
+            int64_t localCorrected = 0;
+            for (size_t chunk = nextChunk++; chunk < numChunks; chunk = nextChunk++) {
+                size_t begin = chunk * chunkSize;
+                sumMiddleValuesInRange(input, rules, begin, std::min(begin + chunkSize, input.size()),
+                                       localTotal, localCorrected, selectMiddle);
+            }
+            return {localTotal, localCorrected};
+        }));
+    }
+
+    for (auto& future : futures) {
+        std::pair<int64_t, int64_t> local = future.get();
+        total += local.first;
+        correctedTotal += local.second;
+    }
+}
+
 /** 
  * Main block. Receives a filename as an argument and reads the file into a map and a nested vector.
  */
 int main(int argc, char* argv[]) {
     // Check if the file name was provided as an argument
-    if (argc != 2) {
-        std::cerr << "Usage: " << argv[0] << " <filename>" << std::endl;
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <filename> [--select] [--parallel <threads>]" << std::endl;
         return 1;
     }
 
+    // Whether to find the middle of misordered rows without correcting them
+    bool selectMiddle = false;
+
+    // Number of threads to check the rows with
+    unsigned threads = 1;
+
+    // Parse the options
+    for (int i = 2; i < argc; i++) {
+        std::string option = argv[i];
+        if (option == "--select") {
+            selectMiddle = true;
+        } else if (option == "--parallel" && i + 1 < argc) {
+            threads = std::stoul(argv[++i]);
+            if (threads == 0) {
+                threads = std::max(std::thread::hardware_concurrency(), 1u);
+            }
+        } else {
+            std::cerr << "Usage: " << argv[0] << " <filename> [--select] [--parallel <threads>]" << std::endl;
+            return 1;
+        }
+    }
+
     // Get the file name from the command-line argument
     std::string filename = argv[1];
 
@@ -142,10 +359,10 @@ int main(int argc, char* argv[]) {
     std::vector<std::vector<int>> input;
 
     // Int to store the sum of the middle values
-    int total = 0;
+    int64_t total = 0;
 
     //in to store the corrected total
-    int correctedTotal = 0;
+    int64_t correctedTotal = 0;
 
     // Read the file into orderRules and input
     if (!readFileIntoMap(filename, orderRules, input)) {
@@ -169,8 +386,12 @@ int main(int argc, char* argv[]) {
         }
     }
 
+    // Compile the rules once for every row
+    RuleMatrix rules;
+    buildRuleMatrix(orderRules, rules);
+
     // Sum the middle values of the rows that follow the rules
-    sumMiddleValues(input, orderRules, total, correctedTotal);
+    sumMiddleValues(input, rules, total, correctedTotal, selectMiddle, threads);
     // Output the total
     std::cout << "Total: " << total << std::endl;
     std::cout << "Corrected Total: " << correctedTotal << std::endl;